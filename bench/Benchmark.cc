@@ -0,0 +1,293 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <sstream>
+
+#if defined (__unix__) || defined (__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+	std::atomic<std::uint64_t>	g_allocations (0);
+	std::atomic<std::uint64_t>	g_bytes (0);
+
+	void * allocate (std::size_t size) {
+		g_allocations.fetch_add (1, std::memory_order_relaxed);
+		g_bytes.fetch_add (size, std::memory_order_relaxed);
+
+		void * p = std::malloc (size == 0 ? 1 : size);
+		if (p == nullptr) {
+			throw std::bad_alloc ();
+		}
+		return p;
+	}
+}
+
+// Replacement global allocation functions, used to count allocations:
+void * operator new (std::size_t size) {
+	return allocate (size);
+}
+
+void * operator new[] (std::size_t size) {
+	return allocate (size);
+}
+
+void * operator new (std::size_t size, const std::nothrow_t &) noexcept {
+	try {
+		return allocate (size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void * operator new[] (std::size_t size, const std::nothrow_t &) noexcept {
+	try {
+		return allocate (size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void operator delete (void * p) noexcept {
+	std::free (p);
+}
+
+void operator delete[] (void * p) noexcept {
+	std::free (p);
+}
+
+void operator delete (void * p, const std::nothrow_t &) noexcept {
+	std::free (p);
+}
+
+void operator delete[] (void * p, const std::nothrow_t &) noexcept {
+	std::free (p);
+}
+
+namespace cyclone {
+namespace bench {
+
+	AllocationCounters allocationCounters () {
+		AllocationCounters counters;
+		counters.allocations = g_allocations.load (std::memory_order_relaxed);
+		counters.bytes = g_bytes.load (std::memory_order_relaxed);
+		return counters;
+	}
+
+	void resetPeakRss () {
+		// Linux resets the peak RSS (VmHWM) when "5" is written to clear_refs:
+		std::ofstream clearRefs ("/proc/self/clear_refs");
+		if (clearRefs) {
+			clearRefs << "5";
+		}
+	}
+
+	std::uint64_t peakRss () {
+		std::ifstream status ("/proc/self/status");
+		std::string line;
+		while (status && std::getline (status, line)) {
+			if (line.compare (0, 6, "VmHWM:") == 0) {
+				return std::strtoull (line.c_str () + 6, nullptr, 10);
+			}
+		}
+
+#if defined (__unix__) || defined (__APPLE__)
+		struct rusage usage;
+		if (getrusage (RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+			return usage.ru_maxrss / 1024;
+#else
+			return usage.ru_maxrss;
+#endif
+		}
+#endif
+		return 0;
+	}
+
+	Options :: Options ()
+		: minSize (1024),
+		  maxSize (16 * 1024 * 1024),
+		  minIterations (1),
+		  maxIterations (1000000),
+		  timeBudgetMs (200),
+		  format ("tsv") {
+	}
+
+	std::uint64_t parseSize (const std::string & value) {
+		char * end = nullptr;
+		std::uint64_t size = std::strtoull (value.c_str (), &end, 10);
+
+		switch (*end) {
+		case 'k': case 'K':
+			return size * 1024;
+		case 'm': case 'M':
+			return size * 1024 * 1024;
+		case 'g': case 'G':
+			return size * 1024 * 1024 * 1024;
+		default:
+			return size;
+		}
+	}
+
+	std::string formatSize (std::uint64_t size) {
+		std::ostringstream s;
+		if (size >= 1024 * 1024 * 1024 && size % (1024 * 1024 * 1024) == 0) {
+			s << (size / (1024 * 1024 * 1024)) << "G";
+		} else if (size >= 1024 * 1024 && size % (1024 * 1024) == 0) {
+			s << (size / (1024 * 1024)) << "M";
+		} else if (size >= 1024 && size % 1024 == 0) {
+			s << (size / 1024) << "K";
+		} else {
+			s << size;
+		}
+		return s.str ();
+	}
+
+	bool parseOptions (int argc, char * argv[], Options & options, std::ostream & error) {
+		for (int i = 1; i < argc; ++ i) {
+			std::string arg (argv[i]);
+
+			if (arg.compare (0, 2, "--") != 0) {
+				options.arguments.push_back (arg);
+				continue;
+			}
+
+			if (i + 1 >= argc) {
+				error << "Missing value for " << arg << std::endl;
+				return false;
+			}
+
+			std::string value (argv[++ i]);
+
+			if (arg == "--min-size" && parseSize (value) > 0) {
+				options.minSize = parseSize (value);
+			} else if (arg == "--max-size") {
+				options.maxSize = parseSize (value);
+			} else if (arg == "--min-iterations") {
+				options.minIterations = std::strtoull (value.c_str (), nullptr, 10);
+			} else if (arg == "--max-iterations") {
+				options.maxIterations = std::strtoull (value.c_str (), nullptr, 10);
+			} else if (arg == "--time-budget") {
+				options.timeBudgetMs = std::strtod (value.c_str (), nullptr);
+			} else if (arg == "--filter") {
+				options.filter = value;
+			} else if (arg == "--format" && (value == "tsv" || value == "json")) {
+				options.format = value;
+			} else {
+				error << "Invalid option: " << arg << " " << value << std::endl;
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	std::vector<std::uint64_t> sizes (const Options & options, std::uint64_t factor) {
+		std::vector<std::uint64_t> result;
+		for (std::uint64_t size = options.minSize; size <= options.maxSize; size *= factor) {
+			result.push_back (size);
+
+			// A zero size or a factor below two would never grow past maxSize:
+			if (size == 0 || factor < 2 || size > options.maxSize / factor) {
+				break;
+			}
+		}
+		return result;
+	}
+
+	Runner :: Runner (const Options & options, std::ostream & out)
+		: m_options (options), m_out (out), m_headerWritten (false) {
+	}
+
+	bool Runner :: enabled (const std::string & benchmark) const {
+		return m_options.filter.empty () || benchmark.find (m_options.filter) != std::string::npos;
+	}
+
+	Measurement Runner :: run (const std::string & benchmark, std::uint64_t size, const Operation & operation, std::uint64_t unitsPerOp, std::uint64_t inputBytesPerOp) {
+		Measurement m = measure (benchmark, size, m_options.minIterations, m_options.maxIterations, m_options.timeBudgetMs, operation, unitsPerOp, inputBytesPerOp);
+		report (m);
+		return m;
+	}
+
+	Measurement Runner :: runFixed (const std::string & benchmark, std::uint64_t size, std::uint64_t iterations, const Operation & operation, std::uint64_t unitsPerOp, std::uint64_t inputBytesPerOp) {
+		Measurement m = measure (benchmark, size, iterations, iterations, 0, operation, unitsPerOp, inputBytesPerOp);
+		report (m);
+		return m;
+	}
+
+	Measurement Runner :: measure (const std::string & benchmark, std::uint64_t size, std::uint64_t minIterations, std::uint64_t maxIterations, double timeBudgetMs, const Operation & operation, std::uint64_t unitsPerOp, std::uint64_t inputBytesPerOp) {
+		typedef std::chrono::steady_clock Clock;
+
+		resetPeakRss ();
+
+		AllocationCounters before = allocationCounters ();
+		Clock::time_point start = Clock::now ();
+		Clock::time_point deadline = start + std::chrono::microseconds (static_cast<std::int64_t> (timeBudgetMs * 1000));
+		std::uint64_t iterations = 0;
+
+		while (iterations < maxIterations) {
+			operation (iterations);
+			++ iterations;
+
+			if (iterations >= minIterations && Clock::now () >= deadline) {
+				break;
+			}
+		}
+
+		Clock::time_point stop = Clock::now ();
+		AllocationCounters after = allocationCounters ();
+
+		Measurement m;
+		m.benchmark = benchmark;
+		m.size = size;
+		m.iterations = iterations;
+
+		double ops = double (iterations) * (unitsPerOp == 0 ? 1 : unitsPerOp);
+		double ns = std::chrono::duration<double, std::nano> (stop - start).count ();
+		m.nsPerOp = ns / ops;
+		m.allocationsPerOp = double (after.allocations - before.allocations) / ops;
+		m.bytesPerOp = double (after.bytes - before.bytes) / ops;
+		m.peakRssKb = peakRss ();
+		m.mbPerSecond = ns > 0 ? double (inputBytesPerOp) * iterations / ns * 1000 : 0;
+		return m;
+	}
+
+	void Runner :: report (const Measurement & m) {
+		if (m_options.format == "json") {
+			m_out << "{\"benchmark\":\"" << m.benchmark << "\""
+				<< ",\"size\":" << m.size
+				<< ",\"iterations\":" << m.iterations
+				<< std::fixed << std::setprecision (3)
+				<< ",\"ns_per_op\":" << m.nsPerOp
+				<< ",\"allocations_per_op\":" << m.allocationsPerOp
+				<< ",\"bytes_per_op\":" << m.bytesPerOp
+				<< ",\"peak_rss_kb\":" << m.peakRssKb
+				<< ",\"mb_per_s\":" << m.mbPerSecond
+				<< "}" << std::endl;
+			return;
+		}
+
+		if (!m_headerWritten) {
+			m_out << "benchmark\tsize\titerations\tns_per_op\tallocations_per_op\tbytes_per_op\tpeak_rss_kb\tmb_per_s" << std::endl;
+			m_headerWritten = true;
+		}
+
+		m_out << m.benchmark
+			<< "\t" << m.size
+			<< "\t" << m.iterations
+			<< std::fixed << std::setprecision (3)
+			<< "\t" << m.nsPerOp
+			<< "\t" << m.allocationsPerOp
+			<< "\t" << m.bytesPerOp
+			<< "\t" << m.peakRssKb
+			<< "\t" << m.mbPerSecond
+			<< std::endl;
+	}
+
+}	// namespace bench
+}	// namespace cyclone
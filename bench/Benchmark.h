@@ -0,0 +1,145 @@
+#ifndef CYCLONE_BENCH_BENCHMARK_H__
+#define CYCLONE_BENCH_BENCHMARK_H__
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cyclone {
+namespace bench {
+
+/**
+ * Allocation counters, maintained by the replacement global operator new / delete
+ * in Benchmark.cc. Every benchmark executable links Benchmark.cc.
+ */
+struct AllocationCounters {
+	std::uint64_t	allocations;
+	std::uint64_t	bytes;
+};
+
+AllocationCounters allocationCounters ();
+
+/**
+ * Resets the peak resident set size of the process (where the platform supports it),
+ * and reads the current peak in kilobytes.
+ */
+void resetPeakRss ();
+std::uint64_t peakRss ();
+
+/**
+ * Deterministic random number generator (xorshift64*). The standard distributions
+ * are implementation defined, this one produces the same sequence everywhere so that
+ * traces are identical between releases.
+ */
+class Random {
+public:
+
+	Random (std::uint64_t seed = 0x9E3779B97F4A7C15ull) : m_state (seed == 0 ? 1 : seed) {
+	}
+
+	std::uint64_t next () {
+		m_state ^= m_state >> 12;
+		m_state ^= m_state << 25;
+		m_state ^= m_state >> 27;
+		return m_state * 0x2545F4914F6CDD1Dull;
+	}
+
+	// Returns a value in [0, bound), or 0 when bound is 0:
+	std::uint64_t below (std::uint64_t bound) {
+		return bound == 0 ? 0 : next () % bound;
+	}
+
+private:
+
+	std::uint64_t	m_state;
+};
+
+struct Measurement {
+	std::string		benchmark;
+	std::uint64_t	size;
+	std::uint64_t	iterations;
+	double			nsPerOp;
+	double			allocationsPerOp;
+	double			bytesPerOp;
+	std::uint64_t	peakRssKb;
+	double			mbPerSecond;	// Input throughput, 0 when not applicable.
+};
+
+struct Options {
+	Options ();
+
+	std::uint64_t	minSize;
+	std::uint64_t	maxSize;
+	std::uint64_t	minIterations;
+	std::uint64_t	maxIterations;
+	double			timeBudgetMs;
+	std::string		filter;
+	std::string		format;		// "tsv" or "json"
+	std::vector<std::string>	arguments;	// Positional arguments.
+};
+
+/**
+ * Parses the common command line options:
+ *
+ *   --min-size <n>[K|M|G]    smallest input size (default 1K)
+ *   --max-size <n>[K|M|G]    largest input size (default 16M)
+ *   --min-iterations <n>     minimum number of operations per measurement (default 1)
+ *   --max-iterations <n>     maximum number of operations per measurement (default 1000000)
+ *   --time-budget <ms>       time spent per measurement (default 200)
+ *   --filter <substring>     only run benchmarks whose name contains the substring
+ *   --format tsv|json        output format (default tsv)
+ *
+ * Unknown options and a zero --min-size are reported and cause a false return value.
+ */
+bool parseOptions (int argc, char * argv[], Options & options, std::ostream & error);
+
+std::uint64_t parseSize (const std::string & value);
+std::string formatSize (std::uint64_t size);
+
+/**
+ * Sizes from minSize to maxSize (inclusive), growing by the given factor. A factor below
+ * two yields minSize only.
+ */
+std::vector<std::uint64_t> sizes (const Options & options, std::uint64_t factor = 16);
+
+class Runner {
+public:
+
+	typedef std::function<void (std::uint64_t)>	Operation;
+
+	Runner (const Options & options, std::ostream & out);
+
+	bool enabled (const std::string & benchmark) const;
+
+	/**
+	 * Runs the operation until both the minimum number of iterations and the time budget
+	 * have been reached (or the maximum number of iterations). The argument of the operation
+	 * is the iteration number. When one invocation performs several units of work (e.g. a
+	 * full iteration over a buffer), the per-op figures are divided by unitsPerOp. When the
+	 * operation consumes input, inputBytesPerOp is used to report the throughput.
+	 * Returns the measurement, which has already been written to the output.
+	 */
+	Measurement run (const std::string & benchmark, std::uint64_t size, const Operation & operation, std::uint64_t unitsPerOp = 1, std::uint64_t inputBytesPerOp = 0);
+
+	/**
+	 * Runs the operation exactly the given number of times.
+	 */
+	Measurement runFixed (const std::string & benchmark, std::uint64_t size, std::uint64_t iterations, const Operation & operation, std::uint64_t unitsPerOp = 1, std::uint64_t inputBytesPerOp = 0);
+
+	void report (const Measurement & measurement);
+
+private:
+
+	Measurement measure (const std::string & benchmark, std::uint64_t size, std::uint64_t minIterations, std::uint64_t maxIterations, double timeBudgetMs, const Operation & operation, std::uint64_t unitsPerOp, std::uint64_t inputBytesPerOp);
+
+	const Options &		m_options;
+	std::ostream &		m_out;
+	bool				m_headerWritten;
+};
+
+}	// namespace bench
+}	// namespace cyclone
+
+#endif	// CYCLONE_BENCH_BENCHMARK_H__
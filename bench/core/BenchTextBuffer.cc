@@ -0,0 +1,317 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/Utf8.h>
+#include <utf8/utf8.h>
+#include "../Benchmark.h"
+
+using namespace cyclone::core;
+using namespace cyclone::bench;
+
+// Generates source-like text: words of varying length, separated by spaces and
+// broken into lines of roughly 60 characters.
+static std::u16string makeText (std::size_t length, Random & random) {
+	static const char16_t alphabet[] = u"abcdefghijklmnopqrstuvwxyz_ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789(){};.,=+-*/";
+	static const std::size_t alphabetLength = sizeof (alphabet) / sizeof (char16_t) - 1;
+
+	std::u16string result;
+	result.reserve (length);
+
+	std::size_t column = 0;
+	while (result.length () < length) {
+		std::size_t wordLength = 1 + random.below (10);
+		for (std::size_t i = 0; i < wordLength && result.length () < length; ++ i, ++ column) {
+			result += alphabet[random.below (alphabetLength)];
+		}
+		if (result.length () < length) {
+			if (column >= 60) {
+				result += u'\n';
+				column = 0;
+			} else {
+				result += u' ';
+				++ column;
+			}
+		}
+	}
+
+	return result;
+}
+
+/**
+ * An edit in a recorded trace. Trace files contain one edit per line:
+ *
+ *   insert <offset> <text>
+ *   remove <offset> <length>
+ *   splice <offset> <length> <text>
+ *
+ * The text is UTF-8 and runs to the end of the line, with \n, \t and \\ escapes. Offsets
+ * and lengths are clamped to the document, so that a trace can be replayed on a document
+ * of any size. Empty lines and lines starting with # are ignored.
+ */
+struct TraceEdit {
+	std::size_t		offset;
+	std::size_t		length;
+	std::u16string	text;
+};
+
+static std::u16string unescape (const std::string & value) {
+	std::string result;
+	for (std::size_t i = 0; i < value.length (); ++ i) {
+		if (value[i] == '\\' && i + 1 < value.length ()) {
+			char c = value[++ i];
+			result += c == 'n' ? '\n' : c == 't' ? '\t' : c;
+		} else {
+			result += value[i];
+		}
+	}
+
+	std::u16string text;
+	utf8::utf8to16 (result.begin (), result.end (), back_inserter (text));
+	return text;
+}
+
+static bool loadTrace (const std::string & fileName, std::vector<TraceEdit> & edits) {
+	std::ifstream in (fileName.c_str ());
+	if (!in) {
+		std::cerr << "Cannot open trace " << fileName << std::endl;
+		return false;
+	}
+
+	std::string line;
+	while (std::getline (in, line)) {
+		if (line.empty () || line[0] == '#') {
+			continue;
+		}
+
+		std::istringstream s (line);
+		std::string operation;
+		TraceEdit edit;
+		edit.length = 0;
+
+		s >> operation >> edit.offset;
+		if (operation == "remove" || operation == "splice") {
+			s >> edit.length;
+		}
+		if (operation == "insert" || operation == "splice") {
+			std::string text;
+			s.get ();
+			std::getline (s, text);
+			edit.text = unescape (text);
+		}
+		if (!s && !s.eof ()) {
+			std::cerr << "Invalid trace line in " << fileName << ": " << line << std::endl;
+			return false;
+		}
+
+		edits.push_back (edit);
+	}
+
+	return true;
+}
+
+static TextBuffer applyEdit (const TextBuffer & buffer, const TraceEdit & edit) {
+	std::size_t offset = edit.offset > buffer.length () ? buffer.length () : edit.offset;
+	std::size_t length = offset + edit.length > buffer.length () ? buffer.length () - offset : edit.length;
+
+	return buffer.splice (offset, length, edit.text);
+}
+
+static std::string traceName (const std::string & fileName) {
+	std::size_t slash = fileName.find_last_of ("/\\");
+	return slash == std::string::npos ? fileName : fileName.substr (slash + 1);
+}
+
+int main (int argc, char * argv[]) {
+	Options options;
+	if (!parseOptions (argc, argv, options, std::cerr)) {
+		std::cerr << "Usage: BenchTextBuffer [options] [trace files...]" << std::endl;
+		return 1;
+	}
+
+	std::vector<std::pair<std::string, std::vector<TraceEdit>>> traces;
+	for (const std::string & fileName: options.arguments) {
+		std::vector<TraceEdit> edits;
+		if (!loadTrace (fileName, edits)) {
+			return 1;
+		}
+		traces.push_back (std::make_pair (traceName (fileName), edits));
+	}
+
+	Runner runner (options, std::cout);
+
+	// Sizes are bytes of UTF-16 text:
+	for (std::uint64_t size: sizes (options, 4)) {
+		Random random;
+		std::size_t length = size / sizeof (char16_t);
+		std::u16string text = makeText (length, random);
+		TextBuffer base (text);
+		std::u16string block = makeText (4096, random);
+		TextBuffer blockBuffer (block);
+
+		if (runner.enabled ("construct")) {
+			runner.run ("construct", size, [&] (std::uint64_t) {
+				TextBuffer buffer (text);
+			});
+		}
+
+		if (runner.enabled ("index/random")) {
+			volatile char16_t sink = 0;
+			runner.run ("index/random", size, [&] (std::uint64_t) {
+				sink = base[random.below (length)];
+			});
+		}
+
+		if (runner.enabled ("index/sequential")) {
+			volatile char16_t sink = 0;
+			runner.run ("index/sequential", size, [&] (std::uint64_t i) {
+				sink = base[i % length];
+			});
+		}
+
+		if (runner.enabled ("iterate")) {
+			volatile char16_t sink = 0;
+			runner.run ("iterate", size, [&] (std::uint64_t) {
+				for (char16_t c: base) {
+					sink = c;
+				}
+			}, length, length * sizeof (char16_t));
+		}
+
+		if (runner.enabled ("toString")) {
+			runner.run ("toString", size, [&] (std::uint64_t) {
+				std::u16string s = base.toString ();
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Loading and saving, the generated text is ASCII, the mixed text has a non-ASCII
+		// character every 40 characters:
+		std::string utf8Text;
+		Utf8::fromUtf16 (text.data (), text.length (), utf8Text);
+		std::u16string mixed (text);
+		for (std::size_t i = 0; i < mixed.length (); i += 40) {
+			mixed[i] = i % 80 == 0 ? u'\u00e9' : u'\u4e2d';
+		}
+		std::string utf8Mixed;
+		Utf8::fromUtf16 (mixed.data (), mixed.length (), utf8Mixed);
+
+		const std::pair<const char *, Utf8::Kernel> kernels[] = {
+			{ "utf8/decode", Utf8::bestKernel () },
+			{ "utf8/decode/scalar", Utf8::Kernel::SCALAR },
+		};
+		for (const std::pair<const char *, Utf8::Kernel> & kernel: kernels) {
+			if (runner.enabled (kernel.first)) {
+				runner.run (kernel.first, size, [&] (std::uint64_t) {
+					std::u16string result;
+					Utf8::toUtf16 (utf8Text.data (), utf8Text.length (), result, kernel.second);
+				}, length, utf8Text.length ());
+			}
+		}
+
+		if (runner.enabled ("utf8/decode/mixed")) {
+			runner.run ("utf8/decode/mixed", size, [&] (std::uint64_t) {
+				std::u16string result;
+				Utf8::toUtf16 (utf8Mixed.data (), utf8Mixed.length (), result);
+			}, length, utf8Mixed.length ());
+		}
+
+		const std::pair<const char *, Utf8::Kernel> validateKernels[] = {
+			{ "utf8/validate/mixed", Utf8::bestKernel () },
+			{ "utf8/validate/mixed/scalar", Utf8::Kernel::SCALAR },
+		};
+		for (const std::pair<const char *, Utf8::Kernel> & kernel: validateKernels) {
+			if (runner.enabled (kernel.first)) {
+				runner.run (kernel.first, size, [&] (std::uint64_t) {
+					Utf8::isValid (utf8Mixed.data (), utf8Mixed.length (), kernel.second);
+				}, length, utf8Mixed.length ());
+			}
+		}
+
+		if (runner.enabled ("utf8/decode/library")) {
+			runner.run ("utf8/decode/library", size, [&] (std::uint64_t) {
+				std::u16string result;
+				utf8::utf8to16 (utf8Text.begin (), utf8Text.end (), back_inserter (result));
+			}, length, utf8Text.length ());
+		}
+
+		if (runner.enabled ("utf8/encode")) {
+			runner.run ("utf8/encode", size, [&] (std::uint64_t) {
+				std::string result = base.toUtf8 ();
+			}, length, length * sizeof (char16_t));
+		}
+
+		if (runner.enabled ("utf8/encode/library")) {
+			runner.run ("utf8/encode/library", size, [&] (std::uint64_t) {
+				std::string result;
+				utf8::utf16to8 (text.begin (), text.end (), back_inserter (result));
+			}, length, length * sizeof (char16_t));
+		}
+
+		if (runner.enabled ("append")) {
+			runner.run ("append", size, [&] (std::uint64_t) {
+				TextBuffer buffer = base.append (blockBuffer);
+			});
+		}
+
+		// Typing: single character inserts at a cursor that moves forward, with an occasional
+		// jump to a different position:
+		if (runner.enabled ("trace/typing")) {
+			TextBuffer buffer (base);
+			std::size_t cursor = length / 2;
+			runner.run ("trace/typing", size, [&] (std::uint64_t i) {
+				if (i % 64 == 63) {
+					cursor = random.below (buffer.length () + 1);
+				}
+				buffer = buffer.insert (cursor ++, std::u16string (1, block[i % block.length ()]));
+			});
+		}
+
+		// Paste: 4 KB blocks inserted at random positions:
+		if (runner.enabled ("trace/paste")) {
+			TextBuffer buffer (base);
+			runner.run ("trace/paste", size, [&] (std::uint64_t) {
+				buffer = buffer.insert (random.below (buffer.length () + 1), block);
+			});
+		}
+
+		// Large deletes: removes 10% of the document, always starting from the original:
+		if (runner.enabled ("trace/delete")) {
+			std::size_t deleteLength = length / 10 > 0 ? length / 10 : 1;
+			runner.run ("trace/delete", size, [&] (std::uint64_t) {
+				TextBuffer buffer = base.remove (random.below (length - deleteLength + 1), deleteLength);
+			});
+		}
+
+		// Replace small random ranges:
+		if (runner.enabled ("trace/splice")) {
+			TextBuffer buffer (base);
+			runner.run ("trace/splice", size, [&] (std::uint64_t i) {
+				std::size_t offset = random.below (buffer.length () + 1);
+				std::size_t removed = random.below (16);
+				if (offset + removed > buffer.length ()) {
+					removed = buffer.length () - offset;
+				}
+				buffer = buffer.splice (offset, removed, block.substr (i % 1024, random.below (16)));
+			});
+		}
+
+		// Recorded traces, replayed in full for every iteration:
+		for (const std::pair<std::string, std::vector<TraceEdit>> & trace: traces) {
+			std::string name = "trace/" + trace.first;
+			if (!runner.enabled (name) || trace.second.empty ()) {
+				continue;
+			}
+
+			runner.run (name, size, [&] (std::uint64_t) {
+				TextBuffer buffer (base);
+				for (const TraceEdit & edit: trace.second) {
+					buffer = applyEdit (buffer, edit);
+				}
+			}, trace.second.size ());
+		}
+	}
+
+	return 0;
+}
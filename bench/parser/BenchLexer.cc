@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cyclone/core/SymbolTable.h>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/ThreadPool.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/NumericLiteral.h>
+#include <cyclone/parser/ParallelLexer.h>
+#include <cyclone/parser/TokenStream.h>
+#include "../Benchmark.h"
+#include "Corpus.h"
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+using namespace cyclone::bench;
+
+// Lexes [begin, end) of the buffer, returns the number of tokens:
+static std::size_t lexRange (const TextBuffer & buffer, std::size_t begin, std::size_t end) {
+	Lexer lexer (buffer, buffer.at (begin), buffer.at (end));
+	std::size_t count = 0;
+
+	while (lexer.la ().type () != TokenType::END_OF_INPUT) {
+		lexer.accept ();
+		++ count;
+	}
+
+	return count;
+}
+
+static std::size_t lexAll (const TextBuffer & buffer) {
+	return lexRange (buffer, 0, buffer.length ());
+}
+
+// The offset of the first token that starts at or after offset:
+static std::size_t tokenBoundary (const TextBuffer & buffer, std::size_t offset) {
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	std::size_t boundary = 0;
+
+	while (boundary < offset && !lexer.check (TokenType::END_OF_INPUT)) {
+		boundary += lexer.accept ().length ();
+	}
+	return boundary;
+}
+
+int main (int argc, char * argv[]) {
+	Options options;
+	if (!parseOptions (argc, argv, options, std::cerr)) {
+		std::cerr << "Usage: BenchLexer [options]" << std::endl;
+		return 1;
+	}
+
+	Runner runner (options, std::cout);
+	ThreadPool threadPool;
+
+	// Sizes are bytes of UTF-16 text, ns/op is per code unit:
+	for (std::uint64_t size: sizes (options, 4)) {
+		Random random;
+		std::size_t length = size / sizeof (char16_t);
+		std::u16string source = makeCorpus (corpusKinds ().front (), length, random);
+		TextBuffer buffer (source);
+
+		// Every corpus, as a whole file and as a range of its middle half starting and ending
+		// at token boundaries. Here ns/op and allocations/op are per token, tokens/s is
+		// 1e9 / ns_per_op:
+		for (const CorpusKind & kind: corpusKinds ()) {
+			std::string fileName = std::string ("lex/corpus/") + kind.name;
+			std::string rangeName = std::string ("lex/range/") + kind.name;
+			if (!runner.enabled (fileName) && !runner.enabled (rangeName)) {
+				continue;
+			}
+
+			Random corpusRandom;
+			TextBuffer corpus (makeCorpus (kind, length, corpusRandom));
+
+			if (runner.enabled (fileName)) {
+				std::size_t tokens = lexAll (corpus);
+				runner.run (fileName, size, [&] (std::uint64_t) {
+					lexAll (corpus);
+				}, tokens, length * sizeof (char16_t));
+			}
+
+			// A huge comment has no boundaries in the middle:
+			std::size_t begin = tokenBoundary (corpus, length / 4);
+			std::size_t end = std::max (begin, tokenBoundary (corpus, length / 4 * 3));
+			if (runner.enabled (rangeName) && begin < end) {
+				std::size_t tokens = lexRange (corpus, begin, end);
+				runner.run (rangeName, size, [&] (std::uint64_t) {
+					lexRange (corpus, begin, end);
+				}, tokens, (end - begin) * sizeof (char16_t));
+			}
+		}
+
+		if (runner.enabled ("lex/file")) {
+			runner.run ("lex/file", size, [&] (std::uint64_t) {
+				lexAll (buffer);
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Interns names, with a symbol table shared by all iterations:
+		if (runner.enabled ("lex/symbols")) {
+			SymbolTable symbols;
+			runner.run ("lex/symbols", size, [&] (std::uint64_t) {
+				Lexer lexer (buffer, buffer.begin (), buffer.end (), &symbols);
+				while (lexer.la ().type () != TokenType::END_OF_INPUT) {
+					lexer.accept ();
+				}
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Lexes the UTF-8 encoding of the same text from memory, the source is ASCII:
+		if (runner.enabled ("lex/utf8")) {
+			std::string utf8Source (source.begin (), source.end ());
+			runner.run ("lex/utf8", size, [&] (std::uint64_t) {
+				Utf8Lexer lexer (utf8Source.data (), utf8Source.data () + utf8Source.size ());
+				while (lexer.la ().type () != TokenType::END_OF_INPUT) {
+					lexer.accept ();
+				}
+			}, length, utf8Source.size ());
+		}
+
+		// Decodes the values of numeric constants:
+		if (runner.enabled ("lex/literals")) {
+			runner.run ("lex/literals", size, [&] (std::uint64_t) {
+				NumericLiteralTable literals;
+				Lexer lexer (buffer, buffer.begin (), buffer.end (), nullptr, &literals);
+				while (lexer.la ().type () != TokenType::END_OF_INPUT) {
+					lexer.accept ();
+				}
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Keeps the tokens, bytes/op shows the memory needed per character:
+		if (runner.enabled ("lex/vector")) {
+			runner.run ("lex/vector", size, [&] (std::uint64_t) {
+				Lexer lexer (buffer, buffer.begin (), buffer.end ());
+				std::vector<Token> tokens;
+				while (!lexer.check (TokenType::END_OF_INPUT)) {
+					tokens.push_back (lexer.accept ());
+				}
+			}, length, length * sizeof (char16_t));
+		}
+
+		if (runner.enabled ("lex/stream")) {
+			runner.run ("lex/stream", size, [&] (std::uint64_t) {
+				Lexer lexer (buffer, buffer.begin (), buffer.end ());
+				TokenStream tokens;
+				while (!lexer.check (TokenType::END_OF_INPUT)) {
+					tokens.push_back (lexer.accept ());
+				}
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Lexes on all hardware threads:
+		if (runner.enabled ("lex/parallel")) {
+			ParallelLexer lexer (threadPool);
+			runner.run ("lex/parallel", size, [&] (std::uint64_t) {
+				lexer.lex (buffer);
+			}, length, length * sizeof (char16_t));
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,323 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <cyclone/core/CancellationToken.h>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/ThreadPool.h>
+#include <cyclone/parser/BatchParser.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/Parser.h>
+#include <cyclone/parser/RuleProfiler.h>
+#include <cyclone/syntaxtree/ArenaTree.h>
+#include <cyclone/syntaxtree/FlatTree.h>
+#include <cyclone/syntaxtree/GreenNode.h>
+#include <cyclone/syntaxtree/TreeBuilder.h>
+#include "../Benchmark.h"
+#include "Corpus.h"
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+using namespace cyclone::bench;
+
+static SyntaxTree parse (const TextBuffer & buffer) {
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	Parser parser (lexer);
+	return parser.parse ();
+}
+
+// The number of NAME tokens, by recursion over the pointers:
+static std::size_t countNames (const std::shared_ptr<NodeBase> & node) {
+	if (node->isTerminal ()) {
+		return std::static_pointer_cast<Terminal> (node)->token ().type () == TokenType::NAME ? 1 : 0;
+	}
+
+	const Node & n = static_cast<const Node &> (*node);
+	std::size_t count = 0;
+	for (unsigned i = 0; i < n.nodeCount (); ++ i) {
+		count += countNames (n.node (i));
+	}
+	return count;
+}
+
+// The terminal at offset by summing the lengths of the children:
+static std::shared_ptr<NodeBase> linearLookup (const std::shared_ptr<Node> & root, std::size_t offset) {
+	std::shared_ptr<NodeBase> node = root;
+	std::size_t start = 0;
+	while (node->isNode ()) {
+		const Node & n = static_cast<const Node &> (*node);
+		unsigned i = 0;
+		while (start + n.node (i)->length () <= offset) {
+			start += n.node (i ++)->length ();
+		}
+		node = n.node (i);
+	}
+	return node;
+}
+
+// Counts the nodes and tokens without keeping them:
+class CountingBuilder : public TreeBuilder {
+public:
+
+	CountingBuilder () : nodes (0), tokens (0) {
+	}
+
+	virtual void startNode (NodeType) {
+		++ nodes;
+	}
+
+	virtual void token (const Token &, std::size_t) {
+		++ tokens;
+	}
+
+	virtual void finishNode () {
+	}
+
+	std::size_t	nodes;
+	std::size_t	tokens;
+};
+
+struct NameCounter {
+	std::size_t	count;
+
+	NameCounter () : count (0) {
+	}
+
+	bool enter (const FlatTree &, std::size_t, std::size_t) {
+		return true;
+	}
+
+	void leave (const FlatTree &, std::size_t) {
+	}
+
+	void token (const Token & token, std::size_t) {
+		count += token.type () == TokenType::NAME ? 1 : 0;
+	}
+};
+
+int main (int argc, char * argv[]) {
+	Options options;
+	if (!parseOptions (argc, argv, options, std::cerr)) {
+		std::cerr << "Usage: BenchParser [options]" << std::endl;
+		return 1;
+	}
+
+	Runner runner (options, std::cout);
+
+	// Sizes are bytes of UTF-16 text of the declarations corpus, which parses without errors:
+	const CorpusKind & declarations = corpusKind ("declarations");
+
+	for (std::uint64_t size: sizes (options, 4)) {
+		Random random;
+		std::size_t length = size / sizeof (char16_t);
+		std::u16string source = makeCorpus (declarations, length, random);
+		TextBuffer buffer (source);
+
+		// ns/op is per code unit:
+		if (runner.enabled ("parse/file")) {
+			runner.run ("parse/file", size, [&] (std::uint64_t) {
+				parse (buffer);
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Lexing alone and the outline of a lazy parse, ns/op is per code unit:
+		if (runner.enabled ("parse/lex-only")) {
+			runner.run ("parse/lex-only", size, [&] (std::uint64_t) {
+				Lexer lexer (buffer, buffer.begin (), buffer.end ());
+				while (lexer.accept ().type () != TokenType::END_OF_INPUT) {
+				}
+			}, length, length * sizeof (char16_t));
+		}
+
+		if (runner.enabled ("parse/lazy")) {
+			runner.run ("parse/lazy", size, [&] (std::uint64_t) {
+				Parser::parseLazily (buffer);
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Events only, the memory doesn't grow with the input:
+		if (runner.enabled ("parse/stream")) {
+			runner.run ("parse/stream", size, [&] (std::uint64_t) {
+				Lexer lexer (buffer, buffer.begin (), buffer.end ());
+				CountingBuilder builder;
+				Parser parser (lexer, builder);
+				parser.parseCompilationUnit ();
+			}, length, length * sizeof (char16_t));
+		}
+
+		// With a profiler, the same as parse/file when the parser isn't built with
+		// CYCLONE_PARSER_PROFILING:
+		if (runner.enabled ("parse/profiled")) {
+			runner.run ("parse/profiled", size, [&] (std::uint64_t) {
+				Lexer lexer (buffer, buffer.begin (), buffer.end ());
+				Parser parser (lexer);
+				RuleProfiler profiler;
+				parser.setProfiler (profiler);
+				parser.parse ();
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Cancelled by a deadline of 1 ms, ns/op is per parse: the time past the deadline
+		// doesn't grow with the input:
+		if (runner.enabled ("parse/deadline")) {
+			runner.run ("parse/deadline", size, [&] (std::uint64_t) {
+				CancellationToken token (std::chrono::milliseconds (1));
+				Lexer lexer (buffer, buffer.begin (), buffer.end ());
+				Parser parser (lexer);
+				parser.setCancellationToken (token);
+				parser.parse ();
+			}, 1, length * sizeof (char16_t));
+		}
+
+		// The same tree in an arena, ns/op is per code unit:
+		if (runner.enabled ("parse/arena")) {
+			ArenaTreeBuilder builder;
+			runner.run ("parse/arena", size, [&] (std::uint64_t) {
+				Lexer lexer (buffer, buffer.begin (), buffer.end ());
+				Parser parser (lexer, builder);
+				parser.parseCompilationUnit ();
+				builder.build ();
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Converts to green nodes with a new cache, ns/op is per code unit:
+		if (runner.enabled ("green/convert")) {
+			SyntaxTree tree = parse (buffer);
+			runner.run ("green/convert", size, [&] (std::uint64_t) {
+				GreenNodeCache cache;
+				cache.convert (tree.root ());
+			}, length, length * sizeof (char16_t));
+		}
+
+		// Whole-tree walks counting NAME tokens, ns/op is per node or token:
+		if (runner.enabled ("walk/pointers") || runner.enabled ("walk/flat") || runner.enabled ("walk/flat-convert")) {
+			SyntaxTree tree = parse (buffer);
+			FlatTree flat (tree.root ());
+			std::size_t names = countNames (tree.root ());
+
+			if (runner.enabled ("walk/pointers")) {
+				runner.run ("walk/pointers", size, [&] (std::uint64_t) {
+					if (countNames (tree.root ()) != names) {
+						throw std::logic_error ("walk/pointers");
+					}
+				}, flat.size ());
+			}
+
+			if (runner.enabled ("walk/flat")) {
+				runner.run ("walk/flat", size, [&] (std::uint64_t) {
+					NameCounter counter;
+					flat.walk (counter);
+					if (counter.count != names) {
+						throw std::logic_error ("walk/flat");
+					}
+				}, flat.size ());
+			}
+
+			if (runner.enabled ("walk/flat-convert")) {
+				runner.run ("walk/flat-convert", size, [&] (std::uint64_t) {
+					FlatTree converted (tree.root ());
+				}, flat.size ());
+			}
+		}
+
+		// The path to a random offset, ns/op is per lookup:
+		if (runner.enabled ("lookup/linear") || runner.enabled ("lookup/path")) {
+			SyntaxTree tree = parse (buffer);
+			std::vector<std::size_t> offsets;
+			for (int i = 0; i < 1024; ++ i) {
+				offsets.push_back (random.below (length));
+			}
+
+			if (runner.enabled ("lookup/linear")) {
+				runner.run ("lookup/linear", size, [&] (std::uint64_t iteration) {
+					linearLookup (tree.root (), offsets[iteration % offsets.size ()]);
+				});
+			}
+
+			if (runner.enabled ("lookup/path")) {
+				runner.run ("lookup/path", size, [&] (std::uint64_t iteration) {
+					tree.pathAt (offsets[iteration % offsets.size ()]);
+				});
+			}
+		}
+
+		// Parses the corpus split into 64 files of different sizes, with one thread and with
+		// one per hardware thread, ns/op is per byte:
+		if (runner.enabled ("batch/1-thread") || runner.enabled ("batch/pool")) {
+			char directory[] = "/tmp/BenchParserXXXXXX";
+			if (mkdtemp (directory) == nullptr) {
+				throw std::runtime_error ("mkdtemp");
+			}
+
+			std::string text = buffer.toUtf8 ();
+			std::vector<std::string> paths;
+			for (std::size_t begin = 0, i = 0; begin < text.size (); ++ i) {
+				// Split before a top-level declaration, at a random distance:
+				std::size_t end = begin + random.below (text.size () / 32 + 1);
+				while (i < 63 && end < text.size () && !(text[end] == '\n' && (text.compare (end + 1, 6, "using ") == 0 || text.compare (end + 1, 10, "namespace ") == 0))) {
+					++ end;
+				}
+				end = i < 63 && end < text.size () ? end + 1 : text.size ();
+
+				paths.push_back (std::string (directory) + "/" + std::to_string (i) + ".cy");
+				std::ofstream out (paths.back ().c_str (), std::ios::binary);
+				out.write (text.data () + begin, end - begin);
+				begin = end;
+			}
+
+			for (unsigned threads: { 1u, 0u }) {
+				std::string name (threads == 1 ? "batch/1-thread" : "batch/pool");
+				if (!runner.enabled (name)) {
+					continue;
+				}
+
+				ThreadPool pool (threads);
+				BatchParser batch (pool);
+				runner.run (name, size, [&] (std::uint64_t) {
+					batch.parse (paths, [] (BatchParser::FileResult &) { });
+				}, text.size (), text.size ());
+			}
+
+			for (const std::string & path: paths) {
+				std::remove (path.c_str ());
+			}
+			rmdir (directory);
+		}
+
+		// A keystroke at the end of a using declaration, ns/op is per reparse. The edited
+		// buffers are made up front, splicing a large buffer isn't part of the parser:
+		SyntaxTree tree = parse (buffer);
+		std::vector<std::size_t> offsets;
+		std::vector<TextBuffer> edited;
+		for (std::size_t offset = source.find (u';'); offset != std::u16string::npos && offsets.size () < 64; offset = source.find (u';', offset + 1 + random.below (length / 32))) {
+			offsets.push_back (offset);
+			edited.push_back (buffer.splice (offset, 0, u"x"));
+		}
+
+		if (runner.enabled ("parse/reparse") && !offsets.empty ()) {
+			runner.run ("parse/reparse", size, [&] (std::uint64_t iteration) {
+				std::size_t i = iteration % offsets.size ();
+				Parser::reparse (tree, edited[i], TextEdit (offsets[i], 0, 1));
+			});
+		}
+
+		// Keeps a green tree of every version in one cache, bytes/op is the memory of a
+		// version, the cache only grows by the nodes that changed:
+		if (runner.enabled ("green/versions") && !offsets.empty ()) {
+			GreenNodeCache cache;
+			cache.convert (tree.root ());
+			runner.run ("green/versions", size, [&] (std::uint64_t iteration) {
+				std::size_t i = iteration % offsets.size ();
+				cache.convert (Parser::reparse (tree, edited[i], TextEdit (offsets[i], 0, 1)).root ());
+			});
+		}
+	}
+
+	return 0;
+}
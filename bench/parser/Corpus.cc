@@ -0,0 +1,326 @@
+#include "Corpus.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace cyclone {
+namespace bench {
+
+	namespace {
+		const char16_t * const operators[] = {
+			u"+", u"-", u"*", u"/", u"%", u"<", u">", u"<=", u">=", u"==", u"!=", u"&&", u"||", u"^^",
+			u"&", u"|", u"^", u"=", u"+=", u"-=", u"*=", u"/=", u"%=", u"&=", u"|=", u"^=", u"~=",
+			u"++", u"--", u"!", u"~", u"?", u":", u",", u".", u";", u"(", u")", u"[", u"]", u"{", u"}"
+		};
+		const std::size_t operatorCount = sizeof (operators) / sizeof (operators[0]);
+
+		// The binary operators at the start of the list:
+		const std::size_t binaryOperatorCount = 16;
+
+		const char16_t * const words[] = {
+			u"the", u"value", u"of", u"is", u"a", u"name", u"for", u"when", u"not", u"with", u"returns",
+			u"each", u"module", u"see", u"text", u"and", u"to", u"in", u"this", u"be", u"used", u"by"
+		};
+		const std::size_t wordCount = sizeof (words) / sizeof (words[0]);
+
+		// Identifiers, comments, strings, numbers and punctuation:
+		const std::size_t elementCount = 5;
+
+		class Generator {
+		public:
+
+			Generator (const CorpusKind & kind, std::size_t length, Random & random)
+				: m_kind (kind), m_length (length), m_random (random), m_total (0) {
+				m_text.reserve (length + 256);
+
+				unsigned weights[] = { kind.identifiers, kind.comments, kind.strings, kind.numbers, kind.punctuation };
+				for (std::size_t i = 0; i < elementCount; ++ i) {
+					m_weights[i] = weights[i];
+					m_total += weights[i];
+				}
+
+				// Mostly short names, some long ones:
+				for (int i = 0; i < 512; ++ i) {
+					std::size_t nameLength = 1 + m_random.below (m_random.below (4) == 0 ? 24 : 8);
+					std::u16string name;
+					for (std::size_t j = 0; j < nameLength; ++ j) {
+						std::uint64_t c = m_random.below (j == 0 ? 52 : 64);
+						name += c < 26 ? char16_t (u'a' + c) : c < 52 ? char16_t (u'A' + c - 26) : c < 62 ? char16_t (u'0' + c - 52) : u'_';
+					}
+					m_vocabulary.push_back (name);
+				}
+			}
+
+			std::u16string generate () {
+				switch (m_kind.pathology) {
+				case Pathology::NONE:
+					generateMix ();
+					break;
+				case Pathology::HUGE_COMMENT:
+					generateHugeComment ();
+					break;
+				case Pathology::LONG_IDENTIFIERS:
+					generateLongIdentifiers ();
+					break;
+				case Pathology::DENSE_OPERATORS:
+					while (m_text.length () < m_length) {
+						// Without starting a comment:
+						const char16_t * op = operators[m_random.below (operatorCount)];
+						if (m_text.empty () || m_text.back () != u'/' || (op[0] != u'/' && op[0] != u'*')) {
+							m_text += op;
+						}
+					}
+					break;
+				}
+
+				m_text.resize (m_length);
+				return m_text;
+			}
+
+		private:
+
+			void generateMix () {
+				while (m_text.length () < m_length) {
+					namespaceBlock (0);
+					m_text += u'\n';
+				}
+			}
+
+			void namespaceBlock (std::size_t depth) {
+				std::u16string indent (depth, u'\t');
+				m_text += indent;
+				m_text += u"namespace ";
+				qualifiedName ();
+				m_text += u" {\n";
+
+				for (std::size_t lines = 10 + m_random.below (100); lines > 0 && m_text.length () < m_length; -- lines) {
+					// Some nested namespaces:
+					if (depth < 3 && m_random.below (40) == 0) {
+						namespaceBlock (depth + 1);
+						continue;
+					}
+
+					std::uint64_t pick = m_random.below (m_total);
+					std::size_t element = 0;
+					while (pick >= m_weights[element]) {
+						pick -= m_weights[element ++];
+					}
+
+					m_text += indent;
+					m_text += u'\t';
+					switch (element) {
+					case 0:
+						identifierLine ();
+						break;
+					case 1:
+						commentLine ();
+						break;
+					case 2:
+						stringLine ();
+						break;
+					case 3:
+						numberLine ();
+						break;
+					default:
+						punctuationLine ();
+						break;
+					}
+				}
+
+				m_text += indent;
+				m_text += u"}\n";
+			}
+
+			void generateHugeComment () {
+				m_text += u"/*";
+				while (m_text.length () + 2 < m_length) {
+					m_text += m_random.below (10) == 0 ? u"\n * " : u" ";
+					m_text += words[m_random.below (wordCount)];
+				}
+				m_text.resize (m_length < 2 ? 0 : m_length - 2);
+				m_text += u"*/";
+			}
+
+			void generateLongIdentifiers () {
+				while (m_text.length () < m_length) {
+					m_text += u"using ";
+					for (std::size_t parts = 1 + m_random.below (3); parts > 0; -- parts) {
+						std::size_t length = 1024 + m_random.below (64 * 1024);
+						const std::u16string & name = m_vocabulary[m_random.below (m_vocabulary.size ())];
+						while (length > 0) {
+							std::size_t n = std::min (length, name.length ());
+							m_text.append (name, 0, n);
+							length -= n;
+						}
+						m_text += parts > 1 ? u"." : u";\n";
+					}
+				}
+			}
+
+			const std::u16string & name () {
+				return m_vocabulary[m_random.below (m_vocabulary.size ())];
+			}
+
+			void qualifiedName () {
+				m_text += name ();
+				for (std::size_t parts = m_random.below (4); parts > 0; -- parts) {
+					m_text += u'.';
+					m_text += name ();
+				}
+			}
+
+			// A using declaration, the only declaration besides namespaces the parser knows:
+			void identifierLine () {
+				m_text += u"using ";
+				qualifiedName ();
+				if (m_random.below (3) == 0) {
+					m_text += u" = ";
+					m_text += name ();
+				}
+				m_text += u";\n";
+			}
+
+			void commentLine () {
+				if (m_random.below (3) == 0) {
+					m_text += u"/*";
+					for (std::size_t lines = 1 + m_random.below (5); lines > 0; -- lines) {
+						m_text += u"\n\t * ";
+						sentence (3 + m_random.below (10));
+					}
+					m_text += u"\n\t */\n";
+				} else {
+					m_text += u"// ";
+					sentence (3 + m_random.below (12));
+					m_text += u'\n';
+				}
+			}
+
+			void stringLine () {
+				m_text += name ();
+				m_text += u" = ";
+				if (m_random.below (4) == 0) {
+					static const char16_t * const characters[] = { u"'a'", u"'\\n'", u"'\\''", u"'\\u00e9'" };
+					m_text += characters[m_random.below (4)];
+				} else {
+					m_text += u'"';
+					for (std::size_t n = 1 + m_random.below (8); n > 0; -- n) {
+						static const char16_t * const escapes[] = { u"\\\"", u"\\n", u"\\t", u"\\\\", u"\\u00e9" };
+						m_text += m_random.below (4) == 0 ? escapes[m_random.below (5)] : u" ";
+						m_text += words[m_random.below (wordCount)];
+					}
+					m_text += u'"';
+				}
+				m_text += u";\n";
+			}
+
+			void number () {
+				static const char16_t * const suffixes[] = { u"", u"", u"", u"l", u"f", u"d" };
+				switch (m_random.below (4)) {
+				case 0:
+					m_text += u"0x";
+					for (std::size_t n = 1 + m_random.below (8); n > 0; -- n) {
+						m_text += u"0123456789abcdefABCDEF"[m_random.below (22)];
+					}
+					break;
+				case 1:
+					digits (1 + m_random.below (4));
+					m_text += u'.';
+					digits (1 + m_random.below (6));
+					if (m_random.below (2) == 0) {
+						m_text += m_random.below (2) == 0 ? u"e-" : u"e";
+						digits (1 + m_random.below (2));
+					}
+					break;
+				default:
+					digits (1 + m_random.below (m_random.below (8) == 0 ? 19 : 4));
+					break;
+				}
+				m_text += suffixes[m_random.below (6)];
+			}
+
+			void numberLine () {
+				m_text += name ();
+				m_text += u" = ";
+				number ();
+				for (std::size_t n = m_random.below (3); n > 0; -- n) {
+					m_text += u' ';
+					m_text += operators[m_random.below (binaryOperatorCount)];
+					m_text += u' ';
+					number ();
+				}
+				m_text += u";\n";
+			}
+
+			void punctuationLine () {
+				m_text += u"if (";
+				m_text += name ();
+				for (std::size_t n = 1 + m_random.below (4); n > 0; -- n) {
+					m_text += u' ';
+					m_text += operators[m_random.below (binaryOperatorCount)];
+					m_text += m_random.below (4) == 0 ? u" !" : u" ";
+					m_text += name ();
+				}
+				m_text += u") { ";
+				m_text += name ();
+				m_text += u" (";
+				m_text += name ();
+				m_text += u", ";
+				m_text += name ();
+				m_text += u" [";
+				m_text += name ();
+				m_text += u"]); }\n";
+			}
+
+			void sentence (std::size_t count) {
+				for (std::size_t i = 0; i < count; ++ i) {
+					m_text += i > 0 ? u" " : u"";
+					m_text += words[m_random.below (wordCount)];
+				}
+			}
+
+			void digits (std::size_t count) {
+				for (std::size_t i = 0; i < count; ++ i) {
+					m_text += char16_t (u'0' + m_random.below (10));
+				}
+			}
+
+			const CorpusKind &			m_kind;
+			std::size_t					m_length;
+			Random &					m_random;
+			std::vector<std::u16string>	m_vocabulary;
+			std::u16string				m_text;
+			unsigned					m_weights[elementCount];
+			unsigned					m_total;
+		};
+	}
+
+	const std::vector<CorpusKind> & corpusKinds () {
+		static const std::vector<CorpusKind> kinds = {
+			{ "typical", 35, 20, 10, 10, 25, Pathology::NONE },
+			{ "declarations", 70, 30, 0, 0, 0, Pathology::NONE },
+			{ "identifiers", 80, 5, 5, 5, 5, Pathology::NONE },
+			{ "comments", 10, 75, 5, 5, 5, Pathology::NONE },
+			{ "strings", 10, 5, 70, 5, 10, Pathology::NONE },
+			{ "numbers", 10, 5, 5, 70, 10, Pathology::NONE },
+			{ "punctuation", 10, 5, 5, 10, 70, Pathology::NONE },
+			{ "huge-comment", 0, 0, 0, 0, 0, Pathology::HUGE_COMMENT },
+			{ "long-identifiers", 0, 0, 0, 0, 0, Pathology::LONG_IDENTIFIERS },
+			{ "dense-operators", 0, 0, 0, 0, 0, Pathology::DENSE_OPERATORS }
+		};
+		return kinds;
+	}
+
+	const CorpusKind & corpusKind (const std::string & name) {
+		for (const CorpusKind & kind: corpusKinds ()) {
+			if (name == kind.name) {
+				return kind;
+			}
+		}
+		throw std::invalid_argument ("Unknown corpus kind: " + name);
+	}
+
+	std::u16string makeCorpus (const CorpusKind & kind, std::size_t length, Random & random) {
+		return Generator (kind, length, random).generate ();
+	}
+
+}	// namespace bench
+}	// namespace cyclone
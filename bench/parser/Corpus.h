@@ -0,0 +1,49 @@
+#ifndef CYCLONE_BENCH_CORPUS_H__
+#define CYCLONE_BENCH_CORPUS_H__
+
+#include <string>
+#include <vector>
+#include "../Benchmark.h"
+
+namespace cyclone {
+namespace bench {
+
+enum class Pathology {
+	NONE,
+	HUGE_COMMENT,		// A single comment over the whole text
+	LONG_IDENTIFIERS,	// Qualified names with parts of up to 64K characters
+	DENSE_OPERATORS		// Operators and brackets without any whitespace
+};
+
+/**
+ * A kind of generated source. Realistic kinds are (nested) namespaces of using
+ * declarations, comments and statements, the weights set the mix of identifiers,
+ * comments, strings, numbers and punctuation. Only the declarations kind can be parsed
+ * without errors. Pathological kinds ignore the weights.
+ */
+struct CorpusKind {
+	const char *	name;
+	unsigned		identifiers;
+	unsigned		comments;
+	unsigned		strings;
+	unsigned		numbers;
+	unsigned		punctuation;
+	Pathology		pathology;
+};
+
+// The realistic mixes, starting with the typical one, then the pathological inputs:
+const std::vector<CorpusKind> & corpusKinds ();
+
+// Throws std::invalid_argument for unknown names:
+const CorpusKind & corpusKind (const std::string & name);
+
+/**
+ * Generates length characters of Cyclone-like source. The same random state gives the
+ * same text. Names are drawn from a vocabulary, like the repeated names of real code.
+ */
+std::u16string makeCorpus (const CorpusKind & kind, std::size_t length, Random & random);
+
+}	// namespace bench
+}	// namespace cyclone
+
+#endif	// CYCLONE_BENCH_CORPUS_H__
@@ -0,0 +1,65 @@
+#ifndef CYCLONE_CORE_CANCELLATIONTOKEN_H
+#define CYCLONE_CORE_CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace cyclone {
+namespace core {
+
+/**
+ * Asks a running operation to stop: the operation polls isCancelled () and unwinds when it
+ * returns true. A token is cancelled by cancel (), from any thread, or once its deadline
+ * has passed. Copies share the state, so a copy can be handed to the operation and the
+ * original cancelled.
+ */
+class CancellationToken {
+public:
+
+	typedef std::chrono::steady_clock	Clock;
+
+	// Without a deadline:
+	CancellationToken () : m_state (std::make_shared<State> (false, Clock::time_point::max ())) {
+	}
+
+	// Cancelled once budget has passed from now:
+	explicit CancellationToken (Clock::duration budget) : m_state (std::make_shared<State> (false, Clock::now () + budget)) {
+	}
+
+	void cancel () const {
+		m_state->cancelled.store (true, std::memory_order_relaxed);
+	}
+
+	bool isCancelled () const {
+		if (m_state->cancelled.load (std::memory_order_relaxed)) {
+			return true;
+		}
+		if (m_state->deadline != Clock::time_point::max () && Clock::now () >= m_state->deadline) {
+			m_state->cancelled.store (true, std::memory_order_relaxed);
+			return true;
+		}
+		return false;
+	}
+
+	Clock::time_point deadline () const {
+		return m_state->deadline;
+	}
+
+private:
+
+	struct State {
+		State (bool cancelled, Clock::time_point deadline) : cancelled (cancelled), deadline (deadline) {
+		}
+
+		std::atomic<bool>	cancelled;
+		Clock::time_point	deadline;	// max () for none
+	};
+
+	std::shared_ptr<State>	m_state;
+};
+
+} // namespace core
+} // namespace cyclone
+
+#endif // CYCLONE_CORE_CANCELLATIONTOKEN_H
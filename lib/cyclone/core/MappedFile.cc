@@ -0,0 +1,61 @@
+#include <cyclone/core/MappedFile.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cyclone {
+namespace core {
+
+	namespace {
+		std::runtime_error error (const std::string & what, const std::string & path) {
+			return std::runtime_error (what + " " + path + ": " + std::strerror (errno));
+		}
+	}
+
+	MappedFile :: MappedFile (const std::string & path) : m_data (nullptr), m_size (0) {
+		int fd = open (path.c_str (), O_RDONLY);
+		if (fd < 0) {
+			throw error ("Can't open", path);
+		}
+
+		struct stat status;
+		if (fstat (fd, &status) != 0) {
+			std::runtime_error e (error ("Can't read", path));
+			close (fd);
+			throw e;
+		}
+
+		// An empty file has nothing to map:
+		m_size = status.st_size;
+		if (m_size > 0) {
+			void * data = mmap (nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED) {
+				std::runtime_error e (error ("Can't map", path));
+				close (fd);
+				throw e;
+			}
+			m_data = static_cast<const char *> (data);
+		}
+		close (fd);
+	}
+
+	MappedFile :: ~MappedFile () {
+		if (m_data != nullptr) {
+			munmap (const_cast<char *> (m_data), m_size);
+		}
+	}
+
+	std::size_t MappedFile :: fileSize (const std::string & path) {
+		struct stat status;
+		if (stat (path.c_str (), &status) != 0) {
+			throw error ("Can't read", path);
+		}
+		return status.st_size;
+	}
+
+} // namespace core
+} // namespace cyclone
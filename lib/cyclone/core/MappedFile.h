@@ -0,0 +1,44 @@
+#ifndef CYCLONE_CORE_MAPPEDFILE_H
+#define CYCLONE_CORE_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace cyclone {
+namespace core {
+
+/**
+ * A file mapped read-only into memory, unmapped when the object is destroyed. The pages
+ * are read on first access, and shared with the page cache.
+ */
+class MappedFile {
+public:
+
+	// Throws std::runtime_error when the file can't be opened or mapped:
+	explicit MappedFile (const std::string & path);
+	~MappedFile ();
+
+	MappedFile (const MappedFile &) = delete;
+	MappedFile & operator = (const MappedFile &) = delete;
+
+	const char * data () const {
+		return m_data;
+	}
+
+	std::size_t size () const {
+		return m_size;
+	}
+
+	// The size of a file without mapping it, throws std::runtime_error when it can't be read:
+	static std::size_t fileSize (const std::string & path);
+
+private:
+
+	const char *	m_data;
+	std::size_t		m_size;
+};
+
+} // namespace core
+} // namespace cyclone
+
+#endif // CYCLONE_CORE_MAPPEDFILE_H
@@ -0,0 +1,103 @@
+#ifndef CYCLONE_CORE_RINGBUFFER_H
+#define CYCLONE_CORE_RINGBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+namespace cyclone {
+namespace core {
+
+/**
+ * A FIFO queue on a power-of-two sized array, indexed relative to the front. Pushing and
+ * popping don't allocate as long as the queue stays within its capacity, a full queue
+ * doubles in size. T must be default constructible and copyable.
+ */
+template <typename T>
+class RingBuffer {
+public:
+
+	explicit RingBuffer (std::size_t capacity = 16)
+		: m_data (roundUp (capacity)), m_mask (m_data.size () - 1), m_head (0), m_size (0) {
+	}
+
+	std::size_t size () const {
+		return m_size;
+	}
+
+	bool empty () const {
+		return m_size == 0;
+	}
+
+	std::size_t capacity () const {
+		return m_data.size ();
+	}
+
+	T & operator [] (std::size_t index) {
+		return m_data[(m_head + index) & m_mask];
+	}
+
+	const T & operator [] (std::size_t index) const {
+		return m_data[(m_head + index) & m_mask];
+	}
+
+	T & front () {
+		return m_data[m_head];
+	}
+
+	const T & front () const {
+		return m_data[m_head];
+	}
+
+	void push_back (const T & value) {
+		if (m_size == m_data.size ()) {
+			grow ();
+		}
+
+		m_data[(m_head + m_size) & m_mask] = value;
+		++ m_size;
+	}
+
+	T pop_front () {
+		T value = m_data[m_head];
+		m_head = (m_head + 1) & m_mask;
+		-- m_size;
+		return value;
+	}
+
+	void clear () {
+		m_head = 0;
+		m_size = 0;
+	}
+
+private:
+
+	static std::size_t roundUp (std::size_t capacity) {
+		std::size_t result = 1;
+		while (result < capacity) {
+			result <<= 1;
+		}
+		return result;
+	}
+
+	void grow () {
+		std::vector<T> data (m_data.size () * 2);
+
+		for (std::size_t i = 0; i < m_size; ++ i) {
+			data[i] = (*this)[i];
+		}
+
+		m_data.swap (data);
+		m_mask = m_data.size () - 1;
+		m_head = 0;
+	}
+
+	std::vector<T>	m_data;
+	std::size_t		m_mask;
+	std::size_t		m_head;
+	std::size_t		m_size;
+};
+
+} // namespace core
+} // namespace cyclone
+
+#endif // CYCLONE_CORE_RINGBUFFER_H
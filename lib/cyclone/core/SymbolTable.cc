@@ -0,0 +1,164 @@
+#include <cyclone/core/SymbolTable.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace cyclone {
+namespace core {
+
+	const SymbolTable::Symbol SymbolTable::noSymbol;
+	const std::uint32_t SymbolTable::initialHash;
+
+	std::uint32_t SymbolTable :: hash (const char16_t * data, std::size_t length) {
+		std::uint32_t result = initialHash;
+		for (std::size_t i = 0; i < length; ++ i) {
+			result = hashStep (result, data[i]);
+		}
+		return result;
+	}
+
+	SymbolTable :: SymbolTable () : m_nextSymbol (1) {
+		for (unsigned i = 0; i < chunkCount; ++ i) {
+			m_chunks[i].store (nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	SymbolTable :: ~SymbolTable () {
+		for (unsigned i = 0; i < chunkCount; ++ i) {
+			delete [] m_chunks[i].load (std::memory_order_relaxed);
+		}
+	}
+
+	void SymbolTable :: locate (Symbol symbol, unsigned & chunk, std::size_t & index) {
+		std::uint64_t position = std::uint64_t (symbol) + (1u << firstChunkBits);
+
+		unsigned bits = 0;
+		while ((position >> (bits + 1)) != 0) {
+			++ bits;
+		}
+
+		chunk = bits - firstChunkBits;
+		index = position - (std::uint64_t (1) << bits);
+	}
+
+	SymbolTable::Symbol SymbolTable :: intern (const char16_t * data, std::size_t length, std::uint32_t hash) {
+		Shard & shard = m_shards[hash & (shardCount - 1)];
+		std::lock_guard<std::mutex> lock (shard.mutex);
+
+		if ((shard.count + 1) * 2 > shard.slots.size ()) {
+			grow (shard);
+		}
+
+		std::size_t slot;
+		Symbol symbol = lookup (shard, data, length, hash, slot);
+		if (symbol != noSymbol) {
+			return symbol;
+		}
+
+		symbol = add (data, length, hash);
+		shard.slots[slot] = symbol;
+		++ shard.count;
+		return symbol;
+	}
+
+	SymbolTable::Symbol SymbolTable :: find (const std::u16string & value) const {
+		std::uint32_t h = hash (value.data (), value.length ());
+		const Shard & shard = m_shards[h & (shardCount - 1)];
+		std::lock_guard<std::mutex> lock (shard.mutex);
+
+		std::size_t slot;
+		return lookup (shard, value.data (), value.length (), h, slot);
+	}
+
+	SymbolTable::Symbol SymbolTable :: lookup (const Shard & shard, const char16_t * data, std::size_t length, std::uint32_t hash, std::size_t & slot) const {
+		if (shard.slots.empty ()) {
+			return noSymbol;
+		}
+
+		std::size_t mask = shard.slots.size () - 1;
+		for (slot = (hash >> shardBits) & mask; shard.slots[slot] != noSymbol; slot = (slot + 1) & mask) {
+			const Entry & e = entry (shard.slots[slot]);
+			if (e.hash == hash && e.name.length () == length && std::equal (data, data + length, e.name.begin ())) {
+				return shard.slots[slot];
+			}
+		}
+
+		return noSymbol;
+	}
+
+	SymbolTable::Symbol SymbolTable :: add (const char16_t * data, std::size_t length, std::uint32_t hash) {
+		Symbol symbol = m_nextSymbol.fetch_add (1, std::memory_order_relaxed);
+		if (symbol == noSymbol) {
+			throw std::length_error ("Too many symbols");
+		}
+
+		unsigned chunk;
+		std::size_t index;
+		locate (symbol, chunk, index);
+
+		Entry * entries = m_chunks[chunk].load (std::memory_order_acquire);
+		if (entries == nullptr) {
+			std::lock_guard<std::mutex> lock (m_chunkMutex);
+			entries = m_chunks[chunk].load (std::memory_order_acquire);
+			if (entries == nullptr) {
+				entries = new Entry[std::size_t (1) << (chunk + firstChunkBits)];
+				m_chunks[chunk].store (entries, std::memory_order_release);
+			}
+		}
+
+		entries[index].name.assign (data, length);
+		entries[index].hash = hash;
+		return symbol;
+	}
+
+	void SymbolTable :: grow (Shard & shard) {
+		std::vector<Symbol> slots (std::max<std::size_t> (16, shard.slots.size () * 2), noSymbol);
+		std::size_t mask = slots.size () - 1;
+
+		for (Symbol symbol: shard.slots) {
+			if (symbol != noSymbol) {
+				std::size_t slot = (entry (symbol).hash >> shardBits) & mask;
+				while (slots[slot] != noSymbol) {
+					slot = (slot + 1) & mask;
+				}
+				slots[slot] = symbol;
+			}
+		}
+
+		shard.slots.swap (slots);
+	}
+
+	std::size_t SymbolTable :: memoryUsage () const {
+		std::size_t usage = sizeof (*this);
+
+		// A symbol's name is only complete once the symbol is in its shard, read the names
+		// of the symbols in each shard under its lock:
+		for (unsigned i = 0; i < shardCount; ++ i) {
+			std::lock_guard<std::mutex> lock (m_shards[i].mutex);
+			usage += m_shards[i].slots.capacity () * sizeof (Symbol);
+
+			for (Symbol symbol: m_shards[i].slots) {
+				if (symbol == noSymbol) {
+					continue;
+				}
+
+				// Strings that don't fit the small string buffer:
+				const std::u16string & name = entry (symbol).name;
+				const char * data = reinterpret_cast<const char *> (name.data ());
+				const char * self = reinterpret_cast<const char *> (&name);
+				if (data < self || data >= self + sizeof (name)) {
+					usage += (name.capacity () + 1) * sizeof (char16_t);
+				}
+			}
+		}
+
+		for (unsigned chunk = 0; chunk < chunkCount; ++ chunk) {
+			if (m_chunks[chunk].load (std::memory_order_acquire) != nullptr) {
+				usage += (std::size_t (1) << (chunk + firstChunkBits)) * sizeof (Entry);
+			}
+		}
+
+		return usage;
+	}
+
+} // namespace core
+} // namespace cyclone
@@ -0,0 +1,122 @@
+#ifndef CYCLONE_CORE_SYMBOLTABLE_H
+#define CYCLONE_CORE_SYMBOLTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cyclone {
+namespace core {
+
+/**
+ * Interns strings: equal strings get the same 32-bit symbol, so that names compare as
+ * integers and are stored once. Symbol 0 is never used and means "no symbol". Interning
+ * is thread safe, the table is split into shards by hash that are locked separately.
+ * Interned strings never move: the references returned by name () stay valid for the
+ * lifetime of the table, and reading them needs no locking.
+ */
+class SymbolTable {
+public:
+
+	typedef std::uint32_t Symbol;
+
+	static const Symbol noSymbol = 0;
+
+	// FNV-1a over UTF-16 code units, which can be computed while scanning a string:
+	static const std::uint32_t initialHash = 2166136261u;
+
+	static constexpr std::uint32_t hashStep (std::uint32_t hash, char16_t c) {
+		return (hash ^ c) * 16777619u;
+	}
+
+	static constexpr std::uint32_t hashString (const char16_t * s, std::uint32_t hash = initialHash) {
+		return *s == 0 ? hash : hashString (s + 1, hashStep (hash, *s));
+	}
+
+	static std::uint32_t hash (const char16_t * data, std::size_t length);
+
+	SymbolTable ();
+	~SymbolTable ();
+
+	SymbolTable (const SymbolTable &) = delete;
+	SymbolTable & operator = (const SymbolTable &) = delete;
+
+	// The hash must be hash (data, length), for callers that computed it already:
+	Symbol intern (const char16_t * data, std::size_t length, std::uint32_t hash);
+
+	Symbol intern (const char16_t * data, std::size_t length) {
+		return intern (data, length, hash (data, length));
+	}
+
+	Symbol intern (const std::u16string & value) {
+		return intern (value.data (), value.length ());
+	}
+
+	// Returns the symbol of the string, or noSymbol when it wasn't interned:
+	Symbol find (const std::u16string & value) const;
+
+	const std::u16string & name (Symbol symbol) const {
+		return entry (symbol).name;
+	}
+
+	std::uint32_t symbolHash (Symbol symbol) const {
+		return entry (symbol).hash;
+	}
+
+	// The number of interned strings:
+	std::size_t size () const {
+		return m_nextSymbol.load (std::memory_order_relaxed) - 1;
+	}
+
+	std::size_t memoryUsage () const;
+
+private:
+
+	struct Entry {
+		std::u16string	name;
+		std::uint32_t	hash;
+	};
+
+	// Open addressing table of symbols, protected by its mutex:
+	struct Shard {
+		Shard () : count (0) {
+		}
+
+		mutable std::mutex	mutex;
+		std::vector<Symbol>	slots;
+		std::size_t			count;
+	};
+
+	static const unsigned shardBits = 4;
+	static const unsigned shardCount = 1 << shardBits;
+
+	// Entries are stored in chunks that double in size, chunk k holds the symbols
+	// [2^(k + firstChunkBits) - 2^firstChunkBits, 2^(k + 1 + firstChunkBits) - 2^firstChunkBits):
+	static const unsigned firstChunkBits = 8;
+	static const unsigned chunkCount = 32 - firstChunkBits + 1;
+
+	static void locate (Symbol symbol, unsigned & chunk, std::size_t & index);
+
+	const Entry & entry (Symbol symbol) const {
+		unsigned chunk;
+		std::size_t index;
+		locate (symbol, chunk, index);
+		return m_chunks[chunk].load (std::memory_order_acquire)[index];
+	}
+
+	Symbol lookup (const Shard & shard, const char16_t * data, std::size_t length, std::uint32_t hash, std::size_t & slot) const;
+	Symbol add (const char16_t * data, std::size_t length, std::uint32_t hash);
+	void grow (Shard & shard);
+
+	Shard						m_shards[shardCount];
+	std::atomic<Entry *>		m_chunks[chunkCount];
+	std::atomic<Symbol>			m_nextSymbol;
+	std::mutex					m_chunkMutex;
+};
+
+} // namespace core
+} // namespace cyclone
+
+#endif // CYCLONE_CORE_SYMBOLTABLE_H
@@ -1,8 +1,54 @@
 #include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/Utf8.h>
+#include <stdexcept>
+#include <vector>
 
 namespace cyclone {
 namespace core {
 
+	TextBuffer TextBuffer :: fromUtf8 (const char * data, std::size_t length) {
+		std::u16string value;
+		if (!Utf8::toUtf16 (data, length, value)) {
+			throw std::invalid_argument ("Invalid UTF-8");
+		}
+		return TextBuffer (value);
+	}
+
+	std::string TextBuffer :: toUtf8 () const {
+		std::string result;
+		result.reserve (length ());
+
+		// Encode leaf by leaf, a surrogate pair can be split between two leaves:
+		char16_t pair[2];
+		bool hasHighSurrogate = false;
+		for (TextBufferIterator it = begin (); it.spanRemaining () > 0; ) {
+			const char16_t * data = it.spanData ();
+			std::size_t count = it.spanRemaining ();
+			it.advance (count);
+
+			bool ok = true;
+			if (hasHighSurrogate) {
+				pair[1] = data[0];
+				ok = Utf8::fromUtf16 (pair, 2, result);
+				++ data;
+				-- count;
+				hasHighSurrogate = false;
+			}
+
+			if (count > 0 && data[count - 1] >= 0xd800 && data[count - 1] <= 0xdbff && it.spanRemaining () > 0) {
+				pair[0] = data[count - 1];
+				hasHighSurrogate = true;
+				-- count;
+			}
+
+			if (!ok || !Utf8::fromUtf16 (data, count, result)) {
+				throw std::invalid_argument ("Invalid UTF-16");
+			}
+		}
+
+		return result;
+	}
+
 	TextBuffer TextBuffer :: splice (std::size_t offset, std::size_t length, const std::u16string & replacement) const {
 		if (length == 0 && replacement.length () == 0) {
 			// Nothing to do:
@@ -208,6 +254,101 @@ namespace core {
 		);
 	}
 
+	TextBufferMemoryStats TextBuffer :: memoryStats () const {
+		TextBufferMemoryAccounting accounting;
+		return accounting.add (*this);
+	}
+
+	TextBufferMemoryStats :: TextBufferMemoryStats ()
+		: leafBytes (0),
+		  innerNodeBytes (0),
+		  leafCount (0),
+		  innerNodeCount (0),
+		  characterCount (0),
+		  depth (0) {
+		for (int i = 0; i < histogramBuckets; ++ i) {
+			leafSizeHistogram[i] = 0;
+		}
+	}
+
+	TextBufferMemoryStats TextBufferMemoryAccounting :: add (const TextBuffer & buffer) {
+		typedef internal::TextBufferNodeBase	NodeBase;
+		typedef internal::TextBufferNode		Node;
+
+		TextBufferMemoryStats stats;
+
+		// Post-order walk with an explicit stack, trees built by many small edits can be deep.
+		// Nodes that have been counted before are not descended into, their height is known:
+		std::vector<std::pair<const NodeBase *, bool>> stack;
+		stack.push_back (std::make_pair (buffer.m_root.get (), false));
+
+		while (!stack.empty ()) {
+			const NodeBase * node = stack.back ().first;
+			bool childrenDone = stack.back ().second;
+
+			if (!childrenDone && m_heights.count (node) > 0) {
+				stack.pop_back ();
+				continue;
+			}
+
+			if (node->isSpan ()) {
+				stack.pop_back ();
+
+				std::size_t length = node->length ();
+				int bucket = 0;
+				while (bucket < TextBufferMemoryStats::histogramBuckets - 1 && length >= (std::size_t (1) << bucket)) {
+					++ bucket;
+				}
+
+				stats.leafBytes += node->memoryUsage ();
+				stats.characterCount += length;
+				++ stats.leafCount;
+				++ stats.leafSizeHistogram[bucket];
+				m_heights[node] = 1;
+				continue;
+			}
+
+			const Node * n = static_cast<const Node *> (node);
+
+			if (!childrenDone) {
+				stack.back ().second = true;
+				stack.push_back (std::make_pair (n->right ().get (), false));
+				stack.push_back (std::make_pair (n->left ().get (), false));
+				continue;
+			}
+
+			stack.pop_back ();
+
+			// The same subtree can occur twice in one tree, count it once:
+			if (m_heights.count (node) > 0) {
+				continue;
+			}
+
+			int leftHeight = m_heights[n->left ().get ()];
+			int rightHeight = m_heights[n->right ().get ()];
+
+			stats.innerNodeBytes += node->memoryUsage ();
+			++ stats.innerNodeCount;
+			m_heights[node] = 1 + (leftHeight > rightHeight ? leftHeight : rightHeight);
+		}
+
+		stats.depth = m_heights[buffer.m_root.get ()];
+
+		m_total.leafBytes += stats.leafBytes;
+		m_total.innerNodeBytes += stats.innerNodeBytes;
+		m_total.leafCount += stats.leafCount;
+		m_total.innerNodeCount += stats.innerNodeCount;
+		m_total.characterCount += stats.characterCount;
+		if (stats.depth > m_total.depth) {
+			m_total.depth = stats.depth;
+		}
+		for (int i = 0; i < TextBufferMemoryStats::histogramBuckets; ++ i) {
+			m_total.leafSizeHistogram[i] += stats.leafSizeHistogram[i];
+		}
+
+		return stats;
+	}
+
 	void TextBufferIterator :: setOffset (std::size_t offset) {
 		std::shared_ptr<NodeBase> currentNode = m_buffer->m_root;
 		std::size_t currentOffset = offset;
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <memory>
+#include <unordered_map>
 
 namespace cyclone {
 namespace core {
@@ -30,6 +31,12 @@ namespace internal {
 		virtual std::u16string toString () const = 0;
 		virtual int depth () const = 0;
 
+		// Bytes allocated for this node, excluding its children:
+		virtual std::size_t memoryUsage () const = 0;
+
+		// Estimate of the std::make_shared control block that precedes every node:
+		static const std::size_t sharedBlockOverhead = sizeof (void *) + 2 * sizeof (int);
+
 #ifdef TEXTBUFFER_DEBUG
 		static int m_nodeCount;
 #endif
@@ -59,7 +66,7 @@ namespace internal {
 			return m_value[index];
 		}
 
-		const std::u16string value () const {
+		const std::u16string & value () const {
 			return m_value;
 		}
 
@@ -71,6 +78,19 @@ namespace internal {
 			return m_value;
 		}
 
+		virtual std::size_t memoryUsage () const {
+			std::size_t usage = sharedBlockOverhead + sizeof (*this);
+
+			// Strings that don't fit the small string buffer allocate their characters separately:
+			const char * data = reinterpret_cast<const char *> (m_value.data ());
+			const char * self = reinterpret_cast<const char *> (&m_value);
+			if (data < self || data >= self + sizeof (m_value)) {
+				usage += (m_value.capacity () + 1) * sizeof (char16_t);
+			}
+
+			return usage;
+		}
+
 	private:
 
 		std::u16string	m_value;
@@ -80,7 +100,7 @@ namespace internal {
 	public:
 
 		TextBufferNode (const std::shared_ptr<TextBufferNodeBase> & left, const std::shared_ptr<TextBufferNodeBase> & right)
-			: m_left (left), m_right (right) {
+			: m_left (left), m_right (right), m_length (left->length () + right->length ()) {
 		}
 
 		virtual bool isSpan () const {
@@ -92,7 +112,7 @@ namespace internal {
 		}
 
 		virtual std::size_t length () const {
-			return m_left->length () + m_right->length ();
+			return m_length;
 		}
 
 		std::size_t leftLength () const {
@@ -128,15 +148,44 @@ namespace internal {
 			return m_left->toString () + m_right->toString ();
 		}
 
+		virtual std::size_t memoryUsage () const {
+			return sharedBlockOverhead + sizeof (*this);
+		}
+
 	private:
 
 		std::shared_ptr<TextBufferNodeBase>	m_left;
 		std::shared_ptr<TextBufferNodeBase>	m_right;
+		std::size_t							m_length;	// Nodes are immutable, the length is computed once.
 	};
 
 }
 
 class TextBufferIterator;
+class TextBufferMemoryAccounting;
+
+/**
+ * Memory used by the nodes of one or more text buffers. The leaf size histogram counts
+ * leaves by length in characters: bucket 0 holds empty leaves, bucket i holds leaves with
+ * a length in [2^(i-1), 2^i), the last bucket holds everything larger.
+ */
+struct TextBufferMemoryStats {
+	static const int histogramBuckets = 12;
+
+	TextBufferMemoryStats ();
+
+	std::size_t totalBytes () const {
+		return leafBytes + innerNodeBytes;
+	}
+
+	std::size_t		leafBytes;
+	std::size_t		innerNodeBytes;
+	std::size_t		leafCount;
+	std::size_t		innerNodeCount;
+	std::size_t		characterCount;
+	int				depth;
+	std::size_t		leafSizeHistogram[histogramBuckets];
+};
 
 class TextBuffer {
 private:
@@ -159,6 +208,13 @@ public:
 	TextBuffer (const TextBuffer & other) : m_root (other.m_root) {
 	}
 
+	// Throws std::invalid_argument when the text isn't valid UTF-8:
+	static TextBuffer fromUtf8 (const char * data, std::size_t length);
+
+	static TextBuffer fromUtf8 (const std::string & value) {
+		return fromUtf8 (value.data (), value.length ());
+	}
+
 	TextBuffer & operator = (const TextBuffer & other) {
 		m_root = other.m_root;
 		return *this;
@@ -201,9 +257,16 @@ public:
 		return m_root->toString ();
 	}
 
+	// Throws std::invalid_argument when the text has unpaired surrogates:
+	std::string toUtf8 () const;
+
+	// Memory used by this buffer, nodes shared with other buffers are included:
+	TextBufferMemoryStats memoryStats () const;
+
 private:
 
 	friend class TextBufferIterator;
+	friend class TextBufferMemoryAccounting;
 
 	const std::size_t	maxStringLength = 512;
 
@@ -292,6 +355,25 @@ public:
 		return m_offset;
 	}
 
+	// The characters from the current position up to the end of the current leaf are
+	// contiguous in memory. There are no characters left at the end of the buffer:
+	const char16_t * spanData () const {
+		return m_currentSpan->value ().data () + m_spanOffset;
+	}
+
+	std::size_t spanRemaining () const {
+		return m_currentSpan->length () - m_spanOffset;
+	}
+
+	void advance (std::size_t count) {
+		if (m_spanOffset + count < m_currentSpan->length ()) {
+			m_offset += count;
+			m_spanOffset += count;
+		} else {
+			setOffset (m_offset + count);
+		}
+	}
+
 private:
 
 	void setOffset (std::size_t offset);
@@ -314,6 +396,28 @@ private:
 	std::size_t			m_spanOffset;
 };
 
+/**
+ * Attributes the memory of a set of buffers, counting nodes that are shared between
+ * buffers (e.g. the versions in an undo history) only once. Nodes are identified by
+ * address, so the added buffers must be kept alive while the accounting is in use.
+ */
+class TextBufferMemoryAccounting {
+public:
+
+	// Adds the nodes of the buffer that have not been counted before, returns the
+	// statistics of the newly counted nodes. The depth is that of the buffer itself.
+	TextBufferMemoryStats add (const TextBuffer & buffer);
+
+	const TextBufferMemoryStats & total () const {
+		return m_total;
+	}
+
+private:
+
+	std::unordered_map<const internal::TextBufferNodeBase *, int>	m_heights;
+	TextBufferMemoryStats											m_total;
+};
+
 inline TextBuffer::Iterator TextBuffer :: begin () const {
 	return Iterator (*this, 0);
 }
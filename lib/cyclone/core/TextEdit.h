@@ -0,0 +1,44 @@
+#ifndef CYCLONE_CORE_TEXTEDIT_H
+#define CYCLONE_CORE_TEXTEDIT_H
+
+#include <cstddef>
+
+namespace cyclone {
+namespace core {
+
+/**
+ * Describes a change of a text buffer: removedLength characters at offset were replaced by
+ * insertedLength characters, as done by TextBuffer::splice. Offsets before the edit are
+ * unchanged, offsets after the removed range move by delta ().
+ */
+struct TextEdit {
+	TextEdit () : offset (0), removedLength (0), insertedLength (0) {
+	}
+
+	TextEdit (std::size_t offset, std::size_t removedLength, std::size_t insertedLength)
+		: offset (offset), removedLength (removedLength), insertedLength (insertedLength) {
+	}
+
+	// End of the removed range, in the text before the edit:
+	std::size_t oldEnd () const {
+		return offset + removedLength;
+	}
+
+	// End of the inserted range, in the text after the edit:
+	std::size_t newEnd () const {
+		return offset + insertedLength;
+	}
+
+	std::ptrdiff_t delta () const {
+		return std::ptrdiff_t (insertedLength) - std::ptrdiff_t (removedLength);
+	}
+
+	std::size_t	offset;
+	std::size_t	removedLength;
+	std::size_t	insertedLength;
+};
+
+} // namespace core
+} // namespace cyclone
+
+#endif // CYCLONE_CORE_TEXTEDIT_H
@@ -0,0 +1,58 @@
+#include <cyclone/core/ThreadPool.h>
+
+namespace cyclone {
+namespace core {
+
+	ThreadPool :: ThreadPool (unsigned threadCount) : m_stopping (false) {
+		if (threadCount == 0) {
+			threadCount = std::thread::hardware_concurrency ();
+		}
+		if (threadCount == 0) {
+			threadCount = 1;
+		}
+
+		for (unsigned i = 0; i < threadCount; ++ i) {
+			m_threads.push_back (std::thread (&ThreadPool::run, this));
+		}
+	}
+
+	ThreadPool :: ~ThreadPool () {
+		{
+			std::lock_guard<std::mutex> lock (m_mutex);
+			m_stopping = true;
+		}
+		m_condition.notify_all ();
+
+		for (std::thread & thread: m_threads) {
+			thread.join ();
+		}
+	}
+
+	void ThreadPool :: enqueue (const std::function<void ()> & task) {
+		{
+			std::lock_guard<std::mutex> lock (m_mutex);
+			m_tasks.push_back (task);
+		}
+		m_condition.notify_one ();
+	}
+
+	void ThreadPool :: run () {
+		while (true) {
+			std::function<void ()> task;
+			{
+				std::unique_lock<std::mutex> lock (m_mutex);
+				m_condition.wait (lock, [this] () { return m_stopping || !m_tasks.empty (); });
+
+				if (m_tasks.empty ()) {
+					return;
+				}
+
+				task = m_tasks.front ();
+				m_tasks.pop_front ();
+			}
+			task ();
+		}
+	}
+
+} // namespace core
+} // namespace cyclone
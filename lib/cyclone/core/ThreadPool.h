@@ -0,0 +1,60 @@
+#ifndef CYCLONE_CORE_THREADPOOL_H
+#define CYCLONE_CORE_THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cyclone {
+namespace core {
+
+/**
+ * A fixed number of worker threads running tasks from a shared FIFO queue. Destroying the
+ * pool runs the tasks that are still queued and joins the workers.
+ */
+class ThreadPool {
+public:
+
+	// Uses one thread per hardware thread when threadCount is 0:
+	explicit ThreadPool (unsigned threadCount = 0);
+	~ThreadPool ();
+
+	ThreadPool (const ThreadPool &) = delete;
+	ThreadPool & operator = (const ThreadPool &) = delete;
+
+	unsigned threadCount () const {
+		return m_threads.size ();
+	}
+
+	template <typename Function>
+	std::future<typename std::result_of<Function ()>::type> submit (Function function) {
+		typedef typename std::result_of<Function ()>::type Result;
+
+		std::shared_ptr<std::packaged_task<Result ()>> task = std::make_shared<std::packaged_task<Result ()>> (function);
+		std::future<Result> result = task->get_future ();
+		enqueue ([task] () { (*task) (); });
+		return result;
+	}
+
+private:
+
+	void enqueue (const std::function<void ()> & task);
+	void run ();
+
+	std::vector<std::thread>			m_threads;
+	std::deque<std::function<void ()>>	m_tasks;
+	std::mutex							m_mutex;
+	std::condition_variable				m_condition;
+	bool								m_stopping;
+};
+
+} // namespace core
+} // namespace cyclone
+
+#endif // CYCLONE_CORE_THREADPOOL_H
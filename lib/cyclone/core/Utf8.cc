@@ -0,0 +1,482 @@
+#include <cyclone/core/Utf8.h>
+#include <cstdint>
+#include <cstring>
+
+#if defined (__GNUC__) && defined (__SSE2__) && (defined (__x86_64__) || defined (__i386__))
+#define CYCLONE_UTF8_X86 1
+#include <immintrin.h>
+#endif
+
+namespace cyclone {
+namespace core {
+
+	namespace {
+		// ASCII kernels convert whole blocks of ASCII and return the number of characters
+		// converted, they stop at the first block that has other characters. Without output
+		// they only validate.
+
+		typedef std::size_t (*DecodeKernel) (const unsigned char * data, std::size_t length, char16_t * out);
+		typedef std::size_t (*EncodeKernel) (const char16_t * data, std::size_t length, unsigned char * out);
+
+		// Validation kernels check any UTF-8, not only ASCII:
+		typedef bool (*ValidateKernel) (const unsigned char * data, std::size_t length);
+
+		std::size_t decodeScalar (const unsigned char * data, std::size_t length, char16_t * out) {
+			std::size_t i = 0;
+			for (; i + 8 <= length; i += 8) {
+				std::uint64_t word;
+				std::memcpy (&word, data + i, sizeof (word));
+				if ((word & 0x8080808080808080ull) != 0) {
+					break;
+				}
+				if (out != nullptr) {
+					for (std::size_t j = 0; j < 8; ++ j) {
+						out[i + j] = data[i + j];
+					}
+				}
+			}
+			return i;
+		}
+
+		std::size_t encodeScalar (const char16_t * data, std::size_t length, unsigned char * out) {
+			std::size_t i = 0;
+			for (; i + 4 <= length; i += 4) {
+				std::uint64_t word;
+				std::memcpy (&word, data + i, sizeof (word));
+				if ((word & 0xff80ff80ff80ff80ull) != 0) {
+					break;
+				}
+				for (std::size_t j = 0; j < 4; ++ j) {
+					out[i + j] = (unsigned char) data[i + j];
+				}
+			}
+			return i;
+		}
+
+		bool validateScalar (const unsigned char * data, std::size_t length);
+
+		// The start of the sequence that is cut by the end of data[0, length):
+		std::size_t sequenceStart (const unsigned char * data, std::size_t length) {
+			for (std::size_t i = 1; i <= 3 && i <= length; ++ i) {
+				unsigned char c = data[length - i];
+				if (c < 0x80) {
+					break;
+				}
+				if (c >= 0xc0) {
+					std::size_t sequenceLength = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : 2;
+					return i < sequenceLength ? length - i : length;
+				}
+			}
+			return length;
+		}
+
+#ifdef CYCLONE_UTF8_X86
+		// The vector validation looks at each byte together with the three before it. A byte
+		// must be a continuation byte exactly when one of those leads a sequence that reaches
+		// it, the lead bytes and the second bytes after E0, ED, F0 and F4 rule out the rest
+		// (overlong encodings, surrogates and code points beyond U+10FFFF). Blocks are checked
+		// without branches, the sequence that the last block cuts is left to the scalar code.
+
+		inline __m128i atLeastSse2 (__m128i bytes, unsigned char c) {
+			return _mm_cmpeq_epi8 (_mm_max_epu8 (bytes, _mm_set1_epi8 (char (c))), bytes);
+		}
+
+		inline __m128i atMostSse2 (__m128i bytes, unsigned char c) {
+			return _mm_cmpeq_epi8 (_mm_min_epu8 (bytes, _mm_set1_epi8 (char (c))), bytes);
+		}
+
+		inline __m128i followsSse2 (__m128i previous1, unsigned char c) {
+			return _mm_cmpeq_epi8 (previous1, _mm_set1_epi8 (char (c)));
+		}
+
+		bool validateSse2 (const unsigned char * data, std::size_t length) {
+			__m128i previous = _mm_setzero_si128 ();
+			__m128i error = _mm_setzero_si128 ();
+			std::size_t i = 0;
+
+			for (; i + 16 <= length; i += 16) {
+				__m128i bytes = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + i));
+
+				if (_mm_movemask_epi8 (bytes) == 0) {
+					// ASCII can't continue a sequence from the previous block:
+					if (sequenceStart (data, i) != i) {
+						return false;
+					}
+					previous = bytes;
+					continue;
+				}
+
+				__m128i previous1 = _mm_or_si128 (_mm_slli_si128 (bytes, 1), _mm_srli_si128 (previous, 15));
+				__m128i previous2 = _mm_or_si128 (_mm_slli_si128 (bytes, 2), _mm_srli_si128 (previous, 14));
+				__m128i previous3 = _mm_or_si128 (_mm_slli_si128 (bytes, 3), _mm_srli_si128 (previous, 13));
+
+				__m128i continuation = _mm_cmpeq_epi8 (_mm_and_si128 (bytes, _mm_set1_epi8 (char (0xc0))), _mm_set1_epi8 (char (0x80)));
+				__m128i expected = _mm_or_si128 (atLeastSse2 (previous1, 0xc0),
+					_mm_or_si128 (atLeastSse2 (previous2, 0xe0), atLeastSse2 (previous3, 0xf0)));
+				error = _mm_or_si128 (error, _mm_xor_si128 (continuation, expected));
+
+				// C0, C1 and F5 to FF never occur:
+				error = _mm_or_si128 (error, _mm_cmpeq_epi8 (_mm_and_si128 (bytes, _mm_set1_epi8 (char (0xfe))), _mm_set1_epi8 (char (0xc0))));
+				error = _mm_or_si128 (error, atLeastSse2 (bytes, 0xf5));
+
+				error = _mm_or_si128 (error, _mm_and_si128 (followsSse2 (previous1, 0xe0), atMostSse2 (bytes, 0x9f)));
+				error = _mm_or_si128 (error, _mm_and_si128 (followsSse2 (previous1, 0xed), atLeastSse2 (bytes, 0xa0)));
+				error = _mm_or_si128 (error, _mm_and_si128 (followsSse2 (previous1, 0xf0), atMostSse2 (bytes, 0x8f)));
+				error = _mm_or_si128 (error, _mm_and_si128 (followsSse2 (previous1, 0xf4), atLeastSse2 (bytes, 0x90)));
+
+				previous = bytes;
+			}
+
+			if (_mm_movemask_epi8 (error) != 0) {
+				return false;
+			}
+
+			std::size_t start = sequenceStart (data, i);
+			return validateScalar (data + start, length - start);
+		}
+
+		std::size_t decodeSse2 (const unsigned char * data, std::size_t length, char16_t * out) {
+			const __m128i zero = _mm_setzero_si128 ();
+			std::size_t i = 0;
+
+			for (; i + 16 <= length; i += 16) {
+				__m128i bytes = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + i));
+				if (_mm_movemask_epi8 (bytes) != 0) {
+					break;
+				}
+				if (out != nullptr) {
+					_mm_storeu_si128 (reinterpret_cast<__m128i *> (out + i), _mm_unpacklo_epi8 (bytes, zero));
+					_mm_storeu_si128 (reinterpret_cast<__m128i *> (out + i + 8), _mm_unpackhi_epi8 (bytes, zero));
+				}
+			}
+			return i;
+		}
+
+		std::size_t encodeSse2 (const char16_t * data, std::size_t length, unsigned char * out) {
+			const __m128i mask = _mm_set1_epi16 (short (0xff80));
+			const __m128i zero = _mm_setzero_si128 ();
+			std::size_t i = 0;
+
+			for (; i + 16 <= length; i += 16) {
+				__m128i low = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + i));
+				__m128i high = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + i + 8));
+				__m128i nonAscii = _mm_and_si128 (_mm_or_si128 (low, high), mask);
+				if (_mm_movemask_epi8 (_mm_cmpeq_epi16 (nonAscii, zero)) != 0xffff) {
+					break;
+				}
+				_mm_storeu_si128 (reinterpret_cast<__m128i *> (out + i), _mm_packus_epi16 (low, high));
+			}
+			return i;
+		}
+
+		__attribute__ ((target ("avx2")))
+		std::size_t decodeAvx2 (const unsigned char * data, std::size_t length, char16_t * out) {
+			std::size_t i = 0;
+
+			for (; i + 32 <= length; i += 32) {
+				__m256i bytes = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data + i));
+				if (_mm256_movemask_epi8 (bytes) != 0) {
+					break;
+				}
+				if (out != nullptr) {
+					_mm256_storeu_si256 (reinterpret_cast<__m256i *> (out + i), _mm256_cvtepu8_epi16 (_mm256_castsi256_si128 (bytes)));
+					_mm256_storeu_si256 (reinterpret_cast<__m256i *> (out + i + 16), _mm256_cvtepu8_epi16 (_mm256_extracti128_si256 (bytes, 1)));
+				}
+			}
+			return i + decodeSse2 (data + i, length - i, out != nullptr ? out + i : nullptr);
+		}
+
+		__attribute__ ((target ("avx2")))
+		std::size_t encodeAvx2 (const char16_t * data, std::size_t length, unsigned char * out) {
+			const __m256i mask = _mm256_set1_epi16 (short (0xff80));
+			std::size_t i = 0;
+
+			for (; i + 32 <= length; i += 32) {
+				__m256i low = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data + i));
+				__m256i high = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data + i + 16));
+				if (!_mm256_testz_si256 (_mm256_or_si256 (low, high), mask)) {
+					break;
+				}
+				// The pack works within 128-bit lanes, put the quarters back in order:
+				__m256i packed = _mm256_permute4x64_epi64 (_mm256_packus_epi16 (low, high), 0xd8);
+				_mm256_storeu_si256 (reinterpret_cast<__m256i *> (out + i), packed);
+			}
+			return i + encodeSse2 (data + i, length - i, out + i);
+		}
+
+		__attribute__ ((target ("avx2")))
+		inline __m256i atLeastAvx2 (__m256i bytes, unsigned char c) {
+			return _mm256_cmpeq_epi8 (_mm256_max_epu8 (bytes, _mm256_set1_epi8 (char (c))), bytes);
+		}
+
+		__attribute__ ((target ("avx2")))
+		inline __m256i atMostAvx2 (__m256i bytes, unsigned char c) {
+			return _mm256_cmpeq_epi8 (_mm256_min_epu8 (bytes, _mm256_set1_epi8 (char (c))), bytes);
+		}
+
+		__attribute__ ((target ("avx2")))
+		inline __m256i followsAvx2 (__m256i previous1, unsigned char c) {
+			return _mm256_cmpeq_epi8 (previous1, _mm256_set1_epi8 (char (c)));
+		}
+
+		__attribute__ ((target ("avx2")))
+		bool validateAvx2 (const unsigned char * data, std::size_t length) {
+			__m256i previous = _mm256_setzero_si256 ();
+			__m256i error = _mm256_setzero_si256 ();
+			std::size_t i = 0;
+
+			for (; i + 32 <= length; i += 32) {
+				__m256i bytes = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data + i));
+
+				if (_mm256_movemask_epi8 (bytes) == 0) {
+					if (sequenceStart (data, i) != i) {
+						return false;
+					}
+					previous = bytes;
+					continue;
+				}
+
+				// The byte shifts work within 128-bit lanes, the low lane takes its earlier bytes
+				// from the high lane of the previous block:
+				__m256i earlier = _mm256_permute2x128_si256 (previous, bytes, 0x21);
+				__m256i previous1 = _mm256_alignr_epi8 (bytes, earlier, 15);
+				__m256i previous2 = _mm256_alignr_epi8 (bytes, earlier, 14);
+				__m256i previous3 = _mm256_alignr_epi8 (bytes, earlier, 13);
+
+				__m256i continuation = _mm256_cmpeq_epi8 (_mm256_and_si256 (bytes, _mm256_set1_epi8 (char (0xc0))), _mm256_set1_epi8 (char (0x80)));
+				__m256i expected = _mm256_or_si256 (atLeastAvx2 (previous1, 0xc0),
+					_mm256_or_si256 (atLeastAvx2 (previous2, 0xe0), atLeastAvx2 (previous3, 0xf0)));
+				error = _mm256_or_si256 (error, _mm256_xor_si256 (continuation, expected));
+
+				error = _mm256_or_si256 (error, _mm256_cmpeq_epi8 (_mm256_and_si256 (bytes, _mm256_set1_epi8 (char (0xfe))), _mm256_set1_epi8 (char (0xc0))));
+				error = _mm256_or_si256 (error, atLeastAvx2 (bytes, 0xf5));
+
+				error = _mm256_or_si256 (error, _mm256_and_si256 (followsAvx2 (previous1, 0xe0), atMostAvx2 (bytes, 0x9f)));
+				error = _mm256_or_si256 (error, _mm256_and_si256 (followsAvx2 (previous1, 0xed), atLeastAvx2 (bytes, 0xa0)));
+				error = _mm256_or_si256 (error, _mm256_and_si256 (followsAvx2 (previous1, 0xf0), atMostAvx2 (bytes, 0x8f)));
+				error = _mm256_or_si256 (error, _mm256_and_si256 (followsAvx2 (previous1, 0xf4), atLeastAvx2 (bytes, 0x90)));
+
+				previous = bytes;
+			}
+
+			if (!_mm256_testz_si256 (error, error)) {
+				return false;
+			}
+
+			std::size_t start = sequenceStart (data, i);
+			return validateScalar (data + start, length - start);
+		}
+#endif
+
+		DecodeKernel decodeKernel (Utf8::Kernel kernel) {
+#ifdef CYCLONE_UTF8_X86
+			switch (Utf8::isSupported (kernel) ? kernel : Utf8::Kernel::SCALAR) {
+				case Utf8::Kernel::AVX2:
+					return decodeAvx2;
+				case Utf8::Kernel::SSE2:
+					return decodeSse2;
+				default:
+					break;
+			}
+#endif
+			(void) kernel;
+			return decodeScalar;
+		}
+
+		EncodeKernel encodeKernel (Utf8::Kernel kernel) {
+#ifdef CYCLONE_UTF8_X86
+			switch (Utf8::isSupported (kernel) ? kernel : Utf8::Kernel::SCALAR) {
+				case Utf8::Kernel::AVX2:
+					return encodeAvx2;
+				case Utf8::Kernel::SSE2:
+					return encodeSse2;
+				default:
+					break;
+			}
+#endif
+			(void) kernel;
+			return encodeScalar;
+		}
+
+		ValidateKernel validateKernel (Utf8::Kernel kernel) {
+#ifdef CYCLONE_UTF8_X86
+			switch (Utf8::isSupported (kernel) ? kernel : Utf8::Kernel::SCALAR) {
+				case Utf8::Kernel::AVX2:
+					return validateAvx2;
+				case Utf8::Kernel::SSE2:
+					return validateSse2;
+				default:
+					break;
+			}
+#endif
+			(void) kernel;
+			return validateScalar;
+		}
+
+		/**
+		 * Decodes UTF-8 into out, which has room for length characters, or only validates
+		 * when out is nullptr. Returns the number of characters written, or -1 for invalid
+		 * input.
+		 */
+		std::ptrdiff_t decode (const unsigned char * data, std::size_t length, char16_t * out, DecodeKernel ascii) {
+			const unsigned char * p = data;
+			const unsigned char * end = data + length;
+			char16_t * o = out;
+
+			while (p != end) {
+				if (*p < 0x80) {
+					std::size_t count = ascii (p, end - p, o);
+					p += count;
+					if (o != nullptr) {
+						o += count;
+					}
+
+					// The rest of the run that doesn't fill a block:
+					for (; p != end && *p < 0x80; ++ p) {
+						if (o != nullptr) {
+							*o ++ = *p;
+						}
+					}
+					continue;
+				}
+
+				unsigned char lead = *p;
+				std::size_t sequenceLength = lead >= 0xc2 && lead <= 0xdf ? 2
+					: lead >= 0xe0 && lead <= 0xef ? 3
+					: lead >= 0xf0 && lead <= 0xf4 ? 4
+					: 0;
+
+				if (sequenceLength == 0 || std::size_t (end - p) < sequenceLength) {
+					return -1;
+				}
+
+				std::uint32_t codePoint = lead & (0x7f >> sequenceLength);
+				for (std::size_t i = 1; i < sequenceLength; ++ i) {
+					if ((p[i] & 0xc0) != 0x80) {
+						return -1;
+					}
+					codePoint = (codePoint << 6) | (p[i] & 0x3f);
+				}
+
+				// Overlong encodings, surrogates and code points beyond U+10FFFF:
+				if ((sequenceLength == 3 && (codePoint < 0x800 || (codePoint >= 0xd800 && codePoint <= 0xdfff)))
+						|| (sequenceLength == 4 && (codePoint < 0x10000 || codePoint > 0x10ffff))) {
+					return -1;
+				}
+
+				p += sequenceLength;
+
+				if (o != nullptr) {
+					if (codePoint < 0x10000) {
+						*o ++ = char16_t (codePoint);
+					} else {
+						*o ++ = char16_t (0xd800 + ((codePoint - 0x10000) >> 10));
+						*o ++ = char16_t (0xdc00 + (codePoint & 0x3ff));
+					}
+				}
+			}
+
+			return o - out;
+		}
+
+		// Encodes into out, which has room for 3 bytes per character:
+		std::ptrdiff_t encode (const char16_t * data, std::size_t length, unsigned char * out, EncodeKernel ascii) {
+			const char16_t * p = data;
+			const char16_t * end = data + length;
+			unsigned char * o = out;
+
+			while (p != end) {
+				if (*p < 0x80) {
+					std::size_t count = ascii (p, end - p, o);
+					p += count;
+					o += count;
+
+					for (; p != end && *p < 0x80; ++ p) {
+						*o ++ = (unsigned char) *p;
+					}
+					continue;
+				}
+
+				std::uint32_t codePoint = *p ++;
+				if (codePoint >= 0xd800 && codePoint <= 0xdfff) {
+					if (codePoint >= 0xdc00 || p == end || *p < 0xdc00 || *p > 0xdfff) {
+						return -1;
+					}
+					codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (*p ++ - 0xdc00);
+				}
+
+				if (codePoint < 0x800) {
+					*o ++ = (unsigned char) (0xc0 | (codePoint >> 6));
+					*o ++ = (unsigned char) (0x80 | (codePoint & 0x3f));
+				} else if (codePoint < 0x10000) {
+					*o ++ = (unsigned char) (0xe0 | (codePoint >> 12));
+					*o ++ = (unsigned char) (0x80 | ((codePoint >> 6) & 0x3f));
+					*o ++ = (unsigned char) (0x80 | (codePoint & 0x3f));
+				} else {
+					*o ++ = (unsigned char) (0xf0 | (codePoint >> 18));
+					*o ++ = (unsigned char) (0x80 | ((codePoint >> 12) & 0x3f));
+					*o ++ = (unsigned char) (0x80 | ((codePoint >> 6) & 0x3f));
+					*o ++ = (unsigned char) (0x80 | (codePoint & 0x3f));
+				}
+			}
+
+			return o - out;
+		}
+
+		bool validateScalar (const unsigned char * data, std::size_t length) {
+			return decode (data, length, nullptr, decodeScalar) >= 0;
+		}
+
+		Utf8::Kernel detectKernel () {
+#ifdef CYCLONE_UTF8_X86
+			__builtin_cpu_init ();
+			return __builtin_cpu_supports ("avx2") ? Utf8::Kernel::AVX2 : Utf8::Kernel::SSE2;
+#else
+			return Utf8::Kernel::SCALAR;
+#endif
+		}
+	}
+
+	Utf8::Kernel Utf8 :: bestKernel () {
+		static const Kernel kernel = detectKernel ();
+		return kernel;
+	}
+
+	bool Utf8 :: isSupported (Kernel kernel) {
+		switch (kernel) {
+			case Kernel::SCALAR:
+				return true;
+			case Kernel::SSE2:
+				return bestKernel () != Kernel::SCALAR;
+			case Kernel::AVX2:
+				return bestKernel () == Kernel::AVX2;
+		}
+		return false;
+	}
+
+	bool Utf8 :: isValid (const char * data, std::size_t length, Kernel kernel) {
+		return validateKernel (kernel) (reinterpret_cast<const unsigned char *> (data), length);
+	}
+
+	bool Utf8 :: toUtf16 (const char * data, std::size_t length, std::u16string & result, Kernel kernel) {
+		// A UTF-8 text never has more UTF-16 code units than bytes:
+		std::size_t start = result.length ();
+		result.resize (start + length);
+
+		std::ptrdiff_t count = decode (reinterpret_cast<const unsigned char *> (data), length, &result[0] + start, decodeKernel (kernel));
+		result.resize (start + (count < 0 ? 0 : count));
+		return count >= 0;
+	}
+
+	bool Utf8 :: fromUtf16 (const char16_t * data, std::size_t length, std::string & result, Kernel kernel) {
+		// At most three bytes per code unit, a surrogate pair takes four bytes for two units:
+		std::size_t start = result.length ();
+		result.resize (start + 3 * length);
+
+		std::ptrdiff_t count = encode (data, length, reinterpret_cast<unsigned char *> (&result[0]) + start, encodeKernel (kernel));
+		result.resize (start + (count < 0 ? 0 : count));
+		return count >= 0;
+	}
+
+} // namespace core
+} // namespace cyclone
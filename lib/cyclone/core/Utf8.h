@@ -0,0 +1,46 @@
+#ifndef CYCLONE_CORE_UTF8_H
+#define CYCLONE_CORE_UTF8_H
+
+#include <cstddef>
+#include <string>
+
+namespace cyclone {
+namespace core {
+
+/**
+ * Validates and transcodes UTF-8 with a kernel that is chosen at runtime from the CPU
+ * features. Validation handles any text a block at a time, transcoding does so for runs
+ * of ASCII only and converts other characters with scalar code. All kernels give the
+ * same results, the scalar one exists everywhere.
+ * Invalid UTF-8 (overlong encodings, surrogates, code points beyond U+10FFFF and
+ * truncated sequences) and unpaired surrogates in UTF-16 are rejected.
+ */
+class Utf8 {
+public:
+
+	enum class Kernel {
+		SCALAR,
+		SSE2,
+		AVX2
+	};
+
+	// The fastest kernel the CPU supports:
+	static Kernel bestKernel ();
+
+	static bool isSupported (Kernel kernel);
+
+	// These fall back to the scalar kernel when the given one isn't supported:
+
+	static bool isValid (const char * data, std::size_t length, Kernel kernel = bestKernel ());
+
+	// Appends the UTF-16 text to result, returns false when the input isn't valid UTF-8:
+	static bool toUtf16 (const char * data, std::size_t length, std::u16string & result, Kernel kernel = bestKernel ());
+
+	// Appends the UTF-8 text to result, returns false on unpaired surrogates:
+	static bool fromUtf16 (const char16_t * data, std::size_t length, std::string & result, Kernel kernel = bestKernel ());
+};
+
+} // namespace core
+} // namespace cyclone
+
+#endif // CYCLONE_CORE_UTF8_H
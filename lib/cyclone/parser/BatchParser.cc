@@ -0,0 +1,166 @@
+#include <cyclone/parser/BatchParser.h>
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <cyclone/core/MappedFile.h>
+#include <cyclone/core/Utf8.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/Parser.h>
+
+using namespace cyclone::core;
+
+namespace cyclone {
+namespace parser {
+
+	const std::size_t BatchParser::defaultMaxInFlightBytes;
+
+	namespace {
+		struct PendingFile {
+			std::size_t	index;
+			std::size_t	bytes;
+		};
+
+		bool largerFile (const PendingFile & a, const PendingFile & b) {
+			return a.bytes > b.bytes;
+		}
+
+		// Shared by the tasks of a batch:
+		struct BatchState {
+			std::mutex					mutex;
+			std::condition_variable		condition;
+			std::size_t					inFlightBytes;
+			BatchParser::Statistics		statistics;
+		};
+
+		// Gives back the bytes of a file when its task ends, also when the callback throws:
+		class InFlight {
+		public:
+
+			InFlight (BatchState & state, std::size_t bytes) : m_state (state), m_bytes (bytes) {
+			}
+
+			~InFlight () {
+				{
+					std::lock_guard<std::mutex> lock (m_state.mutex);
+					m_state.inFlightBytes -= m_bytes;
+				}
+				m_state.condition.notify_all ();
+			}
+
+		private:
+
+			BatchState &	m_state;
+			std::size_t		m_bytes;
+		};
+	}
+
+	BatchParser :: BatchParser (ThreadPool & threadPool, std::size_t maxInFlightBytes)
+		: m_threadPool (threadPool),
+		  m_maxInFlightBytes (maxInFlightBytes) {
+	}
+
+	void BatchParser :: parseFile (FileResult & result) const {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+		try {
+			result.file = std::make_shared<MappedFile> (result.path);
+			result.bytes = result.file->size ();
+			if (!Utf8::isValid (result.file->data (), result.file->size ())) {
+				throw std::invalid_argument ("Invalid UTF-8");
+			}
+		} catch (const std::exception & e) {
+			result.file.reset ();
+			result.error = e.what ();
+			result.readTime = std::chrono::steady_clock::now () - start;
+			return;
+		}
+
+		std::chrono::steady_clock::time_point parsed = std::chrono::steady_clock::now ();
+		result.readTime = parsed - start;
+
+		Utf8Lexer lexer (result.file->data (), result.file->data () + result.file->size ());
+		Parser parser (lexer);
+		result.root = parser.parseCompilationUnit ();
+		result.parseTime = std::chrono::steady_clock::now () - parsed;
+	}
+
+	BatchParser::Statistics BatchParser :: parse (const std::vector<std::string> & paths, const Callback & callback) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
+		// Largest first, a file that can't be read goes last with 0 bytes and fails in its task:
+		std::vector<PendingFile> files;
+		for (std::size_t i = 0; i < paths.size (); ++ i) {
+			PendingFile file;
+			file.index = i;
+			try {
+				file.bytes = MappedFile::fileSize (paths[i]);
+			} catch (const std::runtime_error &) {
+				file.bytes = 0;
+			}
+			files.push_back (file);
+		}
+		std::stable_sort (files.begin (), files.end (), largerFile);
+
+		BatchState state;
+		state.inFlightBytes = 0;
+		state.statistics = Statistics ();
+		std::vector<std::future<void>> results;
+
+		for (const PendingFile & file: files) {
+			{
+				std::unique_lock<std::mutex> lock (state.mutex);
+				state.condition.wait (lock, [&] () {
+					return state.inFlightBytes == 0 || state.inFlightBytes + file.bytes <= m_maxInFlightBytes;
+				});
+				state.inFlightBytes += file.bytes;
+				state.statistics.maxInFlightBytes = std::max (state.statistics.maxInFlightBytes, state.inFlightBytes);
+			}
+
+			const std::string & path = paths[file.index];
+			results.push_back (m_threadPool.submit ([this, &state, &callback, &path, file] () {
+				InFlight inFlight (state, file.bytes);
+
+				FileResult result;
+				result.path = path;
+				result.index = file.index;
+				result.bytes = 0;
+				result.readTime = Duration::zero ();
+				result.parseTime = Duration::zero ();
+				parseFile (result);
+
+				{
+					std::lock_guard<std::mutex> lock (state.mutex);
+					++ state.statistics.fileCount;
+					state.statistics.failedCount += result.root ? 0 : 1;
+					state.statistics.bytes += result.bytes;
+					state.statistics.readTime += result.readTime;
+					state.statistics.parseTime += result.parseTime;
+				}
+
+				callback (result);
+			}));
+		}
+
+		std::exception_ptr error;
+		for (std::future<void> & result: results) {
+			try {
+				result.get ();
+			} catch (...) {
+				if (!error) {
+					error = std::current_exception ();
+				}
+			}
+		}
+		if (error) {
+			std::rethrow_exception (error);
+		}
+
+		state.statistics.wallTime = std::chrono::steady_clock::now () - start;
+		return state.statistics;
+	}
+
+}	// namespace parser
+}	// namespace cyclone
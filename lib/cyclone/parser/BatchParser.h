@@ -0,0 +1,83 @@
+#ifndef CYCLONE_PARSER_BATCHPARSER_H__
+#define CYCLONE_PARSER_BATCHPARSER_H__
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cyclone/core/MappedFile.h>
+#include <cyclone/core/ThreadPool.h>
+#include <cyclone/syntaxtree/Node.h>
+
+namespace cyclone {
+namespace parser {
+
+/**
+ * Parses many files on a thread pool. Each file is memory-mapped, validated as UTF-8 and
+ * parsed by one task, the mapped bytes are lexed directly without a UTF-16 copy. Token
+ * lengths are in UTF-16 code units, as for a TextBuffer of the file. The files are
+ * started largest first, so the small ones fill in at the end instead of one large file
+ * running alone. Only files up to maxInFlightBytes of content are worked on at the same
+ * time (a larger file runs when nothing else does), a file counts until the callback for
+ * it returns.
+ */
+class BatchParser {
+public:
+
+	typedef cyclone::core::MappedFile				MappedFile;
+	typedef cyclone::core::ThreadPool				ThreadPool;
+	typedef cyclone::syntaxtree::Node				Node;
+	typedef std::chrono::steady_clock::duration		Duration;
+
+	static const std::size_t defaultMaxInFlightBytes = 256 * 1024 * 1024;
+
+	struct FileResult {
+		std::string				path;
+		std::size_t				index;		// In the list of files
+		std::size_t				bytes;		// Of the file
+		std::shared_ptr<const MappedFile>	file;	// Its text, unmapped with the last reference
+		std::shared_ptr<Node>	root;		// Null when the file couldn't be read
+		std::string				error;
+		Duration				readTime;	// Mapping and validating
+		Duration				parseTime;
+	};
+
+	struct Statistics {
+		std::size_t		fileCount;
+		std::size_t		failedCount;
+		std::size_t		bytes;
+		std::size_t		maxInFlightBytes;	// The most that was in flight
+		Duration		wallTime;			// From the start to the last callback
+		Duration		readTime;			// Sums of the file times
+		Duration		parseTime;
+	};
+
+	typedef std::function<void (FileResult & result)>	Callback;
+
+	explicit BatchParser (ThreadPool & threadPool, std::size_t maxInFlightBytes = defaultMaxInFlightBytes);
+
+	/**
+	 * Parses the files and calls callback with each result, on the worker threads and for
+	 * several files at the same time. Returns when all are done. An exception of the
+	 * callback is rethrown then, the other files are still parsed. Must not be called from
+	 * a task of the thread pool.
+	 */
+	Statistics parse (const std::vector<std::string> & paths, const Callback & callback);
+
+	std::size_t maxInFlightBytes () const {
+		return m_maxInFlightBytes;
+	}
+
+private:
+
+	void parseFile (FileResult & result) const;
+
+	ThreadPool &	m_threadPool;
+	std::size_t		m_maxInFlightBytes;
+};
+
+}	// namespace parser
+}	// namespace cyclone
+
+#endif	// CYCLONE_PARSER_BATCHPARSER_H__
@@ -0,0 +1,208 @@
+#include <cyclone/parser/IncrementalLexer.h>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace cyclone {
+namespace parser {
+
+	using namespace cyclone::core;
+	using namespace cyclone::syntaxtree;
+
+	const std::size_t IncrementalLexer::defaultCheckpointInterval;
+
+	IncrementalLexer :: IncrementalLexer (const TextBuffer & textBuffer, std::size_t checkpointInterval)
+		: m_textBuffer (textBuffer),
+		  m_tokenCount (0),
+		  m_checkpointInterval (checkpointInterval) {
+		if (checkpointInterval == 0) {
+			throw std::invalid_argument ("Checkpoint interval must not be 0");
+		}
+
+		Lexer lexer (m_textBuffer, m_textBuffer.begin (), m_textBuffer.end ());
+		std::size_t offset = 0;
+
+		for (Token token = lexer.accept (); token.type () != TokenType::END_OF_INPUT; token = lexer.accept ()) {
+			appendToken (m_blocks, token, offset);
+			offset += token.length ();
+		}
+
+		for (std::vector<Block>::iterator it = m_blocks.begin (); it != m_blocks.end (); ++ it) {
+			it->firstToken = m_tokenCount;
+			m_tokenCount += it->tokens.size ();
+		}
+	}
+
+	TokenSplice IncrementalLexer :: update (const TextBuffer & textBuffer, const TextEdit & edit) {
+		// Lexing a token reads at most Scanner::maxLookahead characters past its end, the first
+		// token to relex is the first one that may have read the edited text:
+		std::size_t lookahead = internal::Scanner::maxLookahead;
+		std::size_t first = edit.offset < lookahead ? 0 : tokenAt (edit.offset - lookahead);
+
+		std::size_t start = first < m_tokenCount ? tokenOffset (first) : m_textBuffer.length ();
+		std::ptrdiff_t delta = edit.delta ();
+
+		Lexer lexer (textBuffer, textBuffer.at (start), textBuffer.end ());
+		std::vector<Token> tokens;
+		std::vector<std::size_t> offsets;
+		std::size_t old = first;
+		std::size_t offset = start;
+
+		while (true) {
+			// Past the edit, the text is the same as before. A token starting at the same
+			// position as before starts the same token stream:
+			if (offset >= edit.newEnd ()) {
+				std::size_t oldOffset = offset - delta;
+				while (old < m_tokenCount && tokenOffset (old) < oldOffset) {
+					++ old;
+				}
+				if (old < m_tokenCount && tokenOffset (old) == oldOffset) {
+					break;
+				}
+			}
+
+			Token token = lexer.accept ();
+			if (token.type () == TokenType::END_OF_INPUT) {
+				old = m_tokenCount;
+				break;
+			}
+
+			tokens.push_back (token);
+			offsets.push_back (offset);
+			offset += token.length ();
+		}
+
+		TokenSplice splice;
+		splice.firstToken = first;
+		splice.removedTokens = old - first;
+		splice.insertedTokens = tokens.size ();
+		std::ptrdiff_t tokenDelta = std::ptrdiff_t (splice.insertedTokens) - std::ptrdiff_t (splice.removedTokens);
+
+		// The blocks to rebuild, from the one with the first relexed token to the one with the
+		// first kept token. A small block next to them is merged, edits don't leave more and
+		// more small blocks behind:
+		std::size_t begin = first < m_tokenCount ? blockOfToken (first) : m_blocks.size ();
+		std::size_t end = old < m_tokenCount ? blockOfToken (old) + 1 : m_blocks.size ();
+		if (begin == m_blocks.size () && begin > 0) {
+			-- begin;
+		}
+		if (begin > 0 && m_blocks[begin - 1].length < m_checkpointInterval / 2) {
+			-- begin;
+		}
+		if (end < m_blocks.size () && m_blocks[end].length < m_checkpointInterval / 2) {
+			++ end;
+		}
+
+		std::vector<Block> blocks;
+		for (std::size_t b = begin; b < end; ++ b) {
+			const Block & block = m_blocks[b];
+			for (std::size_t i = 0; i < block.tokens.size () && block.firstToken + i < first; ++ i) {
+				appendToken (blocks, block.tokens[i], block.offset + block.offsets[i]);
+			}
+		}
+		for (std::size_t i = 0; i < tokens.size (); ++ i) {
+			appendToken (blocks, tokens[i], offsets[i]);
+		}
+		for (std::size_t b = begin; b < end; ++ b) {
+			const Block & block = m_blocks[b];
+			for (std::size_t i = 0; i < block.tokens.size (); ++ i) {
+				if (block.firstToken + i >= old) {
+					appendToken (blocks, block.tokens[i], block.offset + block.offsets[i] + delta);
+				}
+			}
+		}
+
+		std::size_t firstToken = begin < m_blocks.size () ? m_blocks[begin].firstToken : 0;
+		for (std::vector<Block>::iterator it = blocks.begin (); it != blocks.end (); ++ it) {
+			it->firstToken = firstToken;
+			firstToken += it->tokens.size ();
+		}
+
+		// Only the starts of the blocks after the rebuilt ones move:
+		m_blocks.erase (m_blocks.begin () + begin, m_blocks.begin () + end);
+		m_blocks.insert (m_blocks.begin () + begin, std::make_move_iterator (blocks.begin ()), std::make_move_iterator (blocks.end ()));
+		for (std::size_t b = begin + blocks.size (); b < m_blocks.size (); ++ b) {
+			m_blocks[b].offset += delta;
+			m_blocks[b].firstToken += tokenDelta;
+		}
+		m_tokenCount += tokenDelta;
+
+		m_textBuffer = textBuffer;
+
+		return splice;
+	}
+
+	void IncrementalLexer :: appendToken (std::vector<Block> & blocks, const Token & token, std::size_t offset) const {
+		if (blocks.empty () || blocks.back ().length + token.length () > m_checkpointInterval) {
+			blocks.push_back (Block ());
+			blocks.back ().offset = offset;
+			blocks.back ().firstToken = 0;
+			blocks.back ().length = 0;
+		}
+
+		Block & block = blocks.back ();
+		block.tokens.push_back (token);
+		block.offsets.push_back (offset - block.offset);
+		block.length += token.length ();
+	}
+
+	std::size_t IncrementalLexer :: blockOfToken (std::size_t index) const {
+		std::vector<Block>::const_iterator it = std::upper_bound (m_blocks.begin (), m_blocks.end (), index,
+			[] (std::size_t index, const Block & block) { return index < block.firstToken; });
+		return it - m_blocks.begin () - 1;
+	}
+
+	std::size_t IncrementalLexer :: blockAt (std::size_t offset) const {
+		std::vector<Block>::const_iterator it = std::upper_bound (m_blocks.begin (), m_blocks.end (), offset,
+			[] (std::size_t offset, const Block & block) { return offset < block.offset; });
+		return it - m_blocks.begin () - 1;
+	}
+
+	const Token & IncrementalLexer :: token (std::size_t index) const {
+		const Block & block = m_blocks[blockOfToken (index)];
+		return block.tokens[index - block.firstToken];
+	}
+
+	std::size_t IncrementalLexer :: tokenOffset (std::size_t index) const {
+		const Block & block = m_blocks[blockOfToken (index)];
+		return block.offset + block.offsets[index - block.firstToken];
+	}
+
+	std::size_t IncrementalLexer :: tokenAt (std::size_t offset) const {
+		if (offset >= m_textBuffer.length ()) {
+			return m_tokenCount;
+		}
+
+		const Block & block = m_blocks[blockAt (offset)];
+		return block.firstToken + (std::upper_bound (block.offsets.begin (), block.offsets.end (), offset - block.offset) - block.offsets.begin ()) - 1;
+	}
+
+	LexerCheckpoint IncrementalLexer :: checkpoint (std::size_t offset) const {
+		LexerCheckpoint checkpoint;
+		checkpoint.offset = 0;
+		checkpoint.tokenIndex = 0;
+
+		if (!m_blocks.empty ()) {
+			const Block & block = offset < m_textBuffer.length () ? m_blocks[blockAt (offset)] : m_blocks.back ();
+			checkpoint.offset = block.offset;
+			checkpoint.tokenIndex = block.firstToken;
+		}
+		return checkpoint;
+	}
+
+	Lexer IncrementalLexer :: lexerAt (std::size_t offset, SymbolTable * symbolTable, NumericLiteralTable * numericLiterals) const {
+		std::size_t index = tokenAt (offset);
+		std::size_t start = index < m_tokenCount ? tokenOffset (index) : m_textBuffer.length ();
+
+		return Lexer (m_textBuffer, m_textBuffer.at (start), m_textBuffer.end (), symbolTable, numericLiterals);
+	}
+
+	std::pair<std::size_t, std::size_t> IncrementalLexer :: tokensInRange (std::size_t begin, std::size_t end) const {
+		std::size_t first = tokenAt (begin);
+		std::size_t last = end > begin ? std::min (tokenAt (end - 1) + 1, m_tokenCount) : first;
+
+		return std::make_pair (first, last);
+	}
+
+}	// namespace parser
+}	// namespace cyclone
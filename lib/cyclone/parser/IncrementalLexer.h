@@ -0,0 +1,122 @@
+#ifndef CYCLONE_PARSER_INCREMENTALLEXER_H__
+#define CYCLONE_PARSER_INCREMENTALLEXER_H__
+
+#include <utility>
+#include <vector>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/TextEdit.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/syntaxtree/Token.h>
+
+namespace cyclone {
+namespace parser {
+
+/**
+ * The tokens that were replaced by an update: removedTokens old tokens starting at
+ * firstToken were replaced by insertedTokens new tokens.
+ */
+struct TokenSplice {
+	std::size_t	firstToken;
+	std::size_t	removedTokens;
+	std::size_t	insertedTokens;
+};
+
+/**
+ * A position where lexing can restart: the start of token tokenIndex. The lexer carries no
+ * state from one token to the next (comments and strings are single tokens), so the offset
+ * is all a new lexer needs to continue with exactly the same tokens.
+ */
+struct LexerCheckpoint {
+	std::size_t	offset;
+	std::size_t	tokenIndex;
+};
+
+/**
+ * The token list of a text buffer, kept up to date while the buffer is edited. The lexer
+ * doesn't carry any state from one token to the next, so lexing can restart at any token
+ * boundary: an update relexes from the last token that can't have seen the edit, and stops
+ * as soon as a new token starts where an old token (moved by the edit) started, past the
+ * edit. From there on both token streams are the same. An unterminated comment or string
+ * simply never re-synchronises and is relexed to the end of the buffer.
+ *
+ * The tokens are stored in blocks of at most checkpointInterval characters (a longer token
+ * has a block of its own), with offsets from the start of their block. The start of each
+ * block is a checkpoint. An update rebuilds the blocks that contain the relexed tokens
+ * and moves the start and first token index of the blocks after them, it doesn't touch
+ * their tokens. A token or checkpoint is found by index or offset with a binary search
+ * among the blocks.
+ *
+ * The list doesn't contain the END_OF_INPUT token.
+ */
+class IncrementalLexer {
+public:
+
+	typedef cyclone::core::TextBuffer		TextBuffer;
+	typedef cyclone::core::TextEdit			TextEdit;
+	typedef cyclone::syntaxtree::Token		Token;
+	typedef cyclone::syntaxtree::TokenType	TokenType;
+
+	static const std::size_t defaultCheckpointInterval = 4096;
+
+	explicit IncrementalLexer (const TextBuffer & textBuffer, std::size_t checkpointInterval = defaultCheckpointInterval);
+
+	/**
+	 * Updates the tokens for textBuffer, which is the previous buffer with edit applied.
+	 */
+	TokenSplice update (const TextBuffer & textBuffer, const TextEdit & edit);
+
+	const TextBuffer & textBuffer () const {
+		return m_textBuffer;
+	}
+
+	std::size_t tokenCount () const {
+		return m_tokenCount;
+	}
+
+	const Token & token (std::size_t index) const;
+	std::size_t tokenOffset (std::size_t index) const;
+
+	// Returns the index of the token that contains offset, or tokenCount () past the last token:
+	std::size_t tokenAt (std::size_t offset) const;
+
+	std::size_t checkpointInterval () const {
+		return m_checkpointInterval;
+	}
+
+	// The checkpoint at or before offset, less than an interval away unless offset is inside a long token:
+	LexerCheckpoint checkpoint (std::size_t offset) const;
+
+	// A lexer that starts at the token that contains offset and continues to the end of the buffer:
+	Lexer lexerAt (std::size_t offset, cyclone::core::SymbolTable * symbolTable = nullptr,
+			NumericLiteralTable * numericLiterals = nullptr) const;
+
+	// The indices of the first token and one past the last token that overlap [begin, end):
+	std::pair<std::size_t, std::size_t> tokensInRange (std::size_t begin, std::size_t end) const;
+
+private:
+
+	struct Block {
+		std::size_t					offset;		// Of the first token
+		std::size_t					firstToken;
+		std::size_t					length;
+		std::vector<Token>			tokens;
+		std::vector<std::size_t>	offsets;	// From the start of the block
+	};
+
+	// The index of the block that contains the token, or of the token at offset:
+	std::size_t blockOfToken (std::size_t index) const;
+	std::size_t blockAt (std::size_t offset) const;
+
+	// Adds a token at offset to the last block, or to a new one:
+	void appendToken (std::vector<Block> & blocks, const Token & token, std::size_t offset) const;
+
+	TextBuffer					m_textBuffer;
+	std::vector<Block>			m_blocks;
+	std::size_t					m_tokenCount;
+	std::size_t					m_checkpointInterval;
+};
+
+}	// namespace parser
+}	// namespace cyclone
+
+#endif	// CYCLONE_PARSER_INCREMENTALLEXER_H__
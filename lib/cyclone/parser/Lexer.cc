@@ -1,4 +1,7 @@
 #include <cyclone/parser/Lexer.h>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
 
 namespace cyclone {
 namespace parser {
@@ -19,17 +22,21 @@ namespace parser {
 		return isDigit (c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
 	}
 
+	bool isNameCharacter (char16_t c) {
+		return c == '_' || c == '$' || isAlpha (c) || isDigit (c);
+	}
+
 	struct StringTokenPair {
-		std::u16string	name;
-		TokenType		tokenType;
+		const char16_t *	name;
+		TokenType			tokenType;
 	};
 
-	StringTokenPair keywords[] = {
+	constexpr StringTokenPair keywords[] = {
 		{ u"namespace", TokenType::NAMESPACE },
 		{ u"using", TokenType::USING }
 	};
 
-	StringTokenPair punctuation[] = {
+	constexpr StringTokenPair punctuation[] = {
 		{ u"(", TokenType::LEFT_BRACE },
 		{ u")", TokenType::RIGHT_BRACE },
 		{ u"{", TokenType::LEFT_CURLY },
@@ -74,27 +81,179 @@ namespace parser {
 		{ u">", TokenType::GREATER_THAN }
 	};
 
-	TokenType findKeyword (const std::u16string & name) {
-		for (unsigned i = 0; i < sizeof (keywords) / sizeof (StringTokenPair); ++ i) {
-			if (keywords[i].name == name) {
-				return keywords[i].tokenType;
+	constexpr std::size_t keywordCount = sizeof (keywords) / sizeof (StringTokenPair);
+	constexpr std::size_t punctuationCount = sizeof (punctuation) / sizeof (StringTokenPair);
+
+	constexpr std::size_t stringLength (const char16_t * s) {
+		return *s == 0 ? 0 : 1 + stringLength (s + 1);
+	}
+
+	constexpr std::size_t maxLength (const StringTokenPair * table, std::size_t count, std::size_t result = 0) {
+		return count == 0 ? result
+			: maxLength (table + 1, count - 1, stringLength (table[0].name) > result ? stringLength (table[0].name) : result);
+	}
+
+	// ---------------------------------------------------------------------------------------
+	// Keywords are found through a perfect hash table that is generated at compile time from
+	// the keyword table. Names are hashed while they are scanned, with the hash that the
+	// symbol table uses, the hash selects the only keyword that can match.
+	// ---------------------------------------------------------------------------------------
+
+	// When adding keywords triggers the static_assert below, increase the number of bits or
+	// try a different multiplier:
+	constexpr unsigned keywordTableBits = 3;
+	constexpr std::uint32_t keywordHashMultiplier = 0x9E3779B1u;
+	constexpr std::size_t keywordTableSize = std::size_t (1) << keywordTableBits;
+	constexpr std::size_t maxKeywordLength = maxLength (keywords, keywordCount);
+
+	constexpr std::size_t keywordSlot (std::uint32_t hash) {
+		return std::uint32_t (hash * keywordHashMultiplier) >> (32 - keywordTableBits);
+	}
+
+	constexpr std::size_t keywordSlotOf (std::size_t keyword) {
+		return keywordSlot (SymbolTable::hashString (keywords[keyword].name));
+	}
+
+	constexpr bool isSlotUnique (std::size_t keyword, std::size_t other) {
+		return other >= keywordCount
+			|| (keywordSlotOf (keyword) != keywordSlotOf (other) && isSlotUnique (keyword, other + 1));
+	}
+
+	constexpr bool isPerfectHash (std::size_t keyword = 0) {
+		return keyword >= keywordCount
+			|| (isSlotUnique (keyword, keyword + 1) && isPerfectHash (keyword + 1));
+	}
+
+	static_assert (isPerfectHash (), "The keyword hash has collisions");
+	static_assert (keywordCount < 256, "Keyword slots are stored in a byte");
+
+	// Returns the index + 1 of the keyword in the slot, or 0 for an empty slot:
+	constexpr std::uint8_t keywordInSlot (std::size_t slot, std::size_t keyword = 0) {
+		return keyword >= keywordCount ? 0
+			: keywordSlotOf (keyword) == slot ? std::uint8_t (keyword + 1)
+			: keywordInSlot (slot, keyword + 1);
+	}
+
+	template <std::size_t... I> struct Indices { };
+	template <std::size_t N, std::size_t... I> struct MakeIndices : MakeIndices<N - 1, N - 1, I...> { };
+	template <std::size_t... I> struct MakeIndices<0, I...> { typedef Indices<I...> Type; };
+
+	struct KeywordTable {
+		std::uint8_t	slots[keywordTableSize];
+	};
+
+	template <std::size_t... I>
+	constexpr KeywordTable makeKeywordTable (Indices<I...>) {
+		return KeywordTable { { keywordInSlot (I)... } };
+	}
+
+	constexpr KeywordTable keywordTable = makeKeywordTable (MakeIndices<keywordTableSize>::Type ());
+
+	// Names up to this length are collected on the stack while they are scanned:
+	constexpr std::size_t nameBufferLength = 64;
+
+	static_assert (maxKeywordLength <= nameBufferLength, "Keywords fit the name buffer");
+
+	// Returns the keyword token type for the name, or NAME. The name is only available when it
+	// isn't longer than the longest keyword:
+	TokenType findKeyword (std::uint32_t hash, const char16_t * name, std::size_t length) {
+		if (length > maxKeywordLength) {
+			return TokenType::NAME;
+		}
+
+		std::uint8_t keyword = keywordTable.slots[keywordSlot (hash)];
+		if (keyword == 0) {
+			return TokenType::NAME;
+		}
+
+		const char16_t * keywordName = keywords[keyword - 1].name;
+		for (std::size_t i = 0; i < length; ++ i) {
+			if (keywordName[i] != name[i]) {
+				return TokenType::NAME;
 			}
 		}
 
-		return TokenType::NAME;
+		return keywordName[length] == 0 ? keywords[keyword - 1].tokenType : TokenType::NAME;
 	}
 
-	TokenType findPunctuation (const std::u16string & value) {
-		for (unsigned i = 0; i < sizeof (punctuation) / sizeof (StringTokenPair); ++ i) {
-			if (punctuation[i].name == value) {
-				return punctuation[i].tokenType;
+	// ---------------------------------------------------------------------------------------
+	// Punctuation is matched by a DFA (a trie over the punctuation table), generated once.
+	// Characters are mapped to classes first, the transition table only has columns for
+	// characters that occur in punctuation.
+	// ---------------------------------------------------------------------------------------
+
+	constexpr std::size_t maxPunctuationLength = maxLength (punctuation, punctuationCount);
+
+	static_assert (maxPunctuationLength <= internal::Scanner::maxLookahead
+		&& maxPunctuationLength <= internal::Utf8Scanner::maxLookahead, "Punctuation is matched within the scanner lookahead");
+
+	class PunctuationMatcher {
+	public:
+
+		PunctuationMatcher () : m_classCount (1) {
+			for (std::size_t c = 0; c < 128; ++ c) {
+				m_classes[c] = 0;
+			}
+
+			for (std::size_t i = 0; i < punctuationCount; ++ i) {
+				for (const char16_t * p = punctuation[i].name; *p != 0; ++ p) {
+					if (m_classes[*p] == 0) {
+						m_classes[*p] = m_classCount ++;
+					}
+				}
+			}
+
+			// State 0 is the start state:
+			addState ();
+
+			for (std::size_t i = 0; i < punctuationCount; ++ i) {
+				std::size_t state = 0;
+				for (const char16_t * p = punctuation[i].name; *p != 0; ++ p) {
+					std::size_t transition = state * m_classCount + m_classes[*p];
+					if (m_transitions[transition] < 0) {
+						std::size_t next = addState ();
+						m_transitions[transition] = std::int16_t (next);
+					}
+					state = m_transitions[transition];
+				}
+				m_accept[state] = punctuation[i].tokenType;
+			}
+		}
+
+		// Returns the next state, or -1 when there is no transition:
+		int next (std::size_t state, char16_t c) const {
+			if (c >= 128 || m_classes[c] == 0) {
+				return -1;
 			}
+			return m_transitions[state * m_classCount + m_classes[c]];
+		}
+
+		// Returns the token type of an accepting state, END_OF_INPUT otherwise:
+		TokenType accept (std::size_t state) const {
+			return m_accept[state];
 		}
 
-		return TokenType::END_OF_INPUT;
+	private:
+
+		std::size_t addState () {
+			m_transitions.resize (m_transitions.size () + m_classCount, -1);
+			m_accept.push_back (TokenType::END_OF_INPUT);
+			return m_accept.size () - 1;
+		}
+
+		std::uint8_t				m_classes[128];
+		std::size_t					m_classCount;
+		std::vector<std::int16_t>	m_transitions;
+		std::vector<TokenType>		m_accept;
+	};
+
+	const PunctuationMatcher & punctuationMatcher () {
+		static const PunctuationMatcher matcher;
+		return matcher;
 	}
 
-	Lexer::Token Lexer :: la (unsigned offset) {
+	template<typename ScannerType>
+	Token BasicLexer<ScannerType> :: la (unsigned offset) {
 		while (m_lookahead.size () <= offset) {
 			next ();
 		}
@@ -102,17 +261,17 @@ namespace parser {
 		return m_lookahead[offset];
 	}
 
-	Token Lexer :: accept () {
+	template<typename ScannerType>
+	Token BasicLexer<ScannerType> :: accept () {
 		// Make sure there is a token in the lookahead list:
 		la (0);
 
 		// Remove the first token from the lookahead list:
-		Token t = m_lookahead[0];
-		m_lookahead.erase (m_lookahead.begin ());
-		return t;
+		return m_lookahead.pop_front ();
 	}
 
-	void Lexer :: next () {
+	template<typename ScannerType>
+	void BasicLexer<ScannerType> :: next () {
 		// Parse EOF:
 		if (m_scanner.isRangeComplete ()) {
 			emit (Token (TokenType::END_OF_INPUT, 0));
@@ -121,26 +280,22 @@ namespace parser {
 
 		// Parse whitespace:
 		if (m_scanner.la () > 0 && m_scanner.la () <= ' ') {
-			std::size_t length = 0;
 			bool hasLineBreak = false;
-			while (m_scanner.la () > 0 && m_scanner.la () <= ' ') {
-				if (m_scanner.la () == '\n') {
+			std::size_t length = m_scanner.acceptWhile ([&hasLineBreak] (char16_t c) {
+				if (c == '\n') {
 					hasLineBreak = true;
 				}
-				++ length;
-				m_scanner.accept ();
-			}
+				return c > 0 && c <= ' ';
+			});
 			emit (Token (TokenType::WHITESPACE, length, hasLineBreak));
 			return;
 		}
 
 		// Parse single line comments:
 		if (m_scanner.la (0) == '/' && m_scanner.la (1) == '/') {
-			std::size_t length = 0;
-			while (m_scanner.la () != 0 && m_scanner.la () != '\r' && m_scanner.la () != '\n') {
-				++ length;
-				m_scanner.accept ();
-			}
+			std::size_t length = m_scanner.acceptWhile ([] (char16_t c) {
+				return c != 0 && c != '\r' && c != '\n';
+			});
 
 			if (m_scanner.la () == '\r' && m_scanner.la (1) == '\n') {
 				length += 2;
@@ -157,9 +312,20 @@ namespace parser {
 
 		// Parse multi-line comments:
 		if (m_scanner.la (0) == '/' && m_scanner.la (1) == '*') {
-			std::size_t length = 0;
+			std::size_t length = 2;
+			m_scanner.accept ();
+			m_scanner.accept ();
+
+			while (true) {
+				length += m_scanner.acceptWhile ([] (char16_t c) {
+					return c != 0 && c != '*';
+				});
+
+				if (m_scanner.la () == 0 || m_scanner.la (1) == '/') {
+					break;
+				}
 
-			while (m_scanner.la () != 0 && !(length >= 2 && m_scanner.la (0) == '*' && m_scanner.la (1) == '/')) {
+				// A '*' that doesn't close the comment:
 				++ length;
 				m_scanner.accept ();
 			}
@@ -215,38 +381,56 @@ namespace parser {
 
 		// Parse names and keywords:
 		if (m_scanner.la (0) == '_' || m_scanner.la (0) == '$' || isAlpha (m_scanner.la (0))) {
-			std::size_t length = 0;
-			std::u16string value;
-
-			while (m_scanner.la () == '_'
-					|| m_scanner.la () == '$'
-					|| isAlpha (m_scanner.la ())
-					|| isDigit (m_scanner.la ())) {
-				++ length;
-				value += m_scanner.accept ();
+			std::uint32_t hash = SymbolTable::initialHash;
+			char16_t name[nameBufferLength];
+			std::u16string longName;
+			bool intern = m_symbolTable != nullptr;
+			std::size_t count = 0;
+			std::size_t length = m_scanner.acceptWhile ([&] (char16_t c) {
+				if (!isNameCharacter (c)) {
+					return false;
+				}
+				hash = SymbolTable::hashStep (hash, c);
+				if (count < nameBufferLength) {
+					name[count] = c;
+				} else if (intern) {
+					if (longName.empty ()) {
+						longName.assign (name, count);
+					}
+					longName += c;
+				}
+				++ count;
+				return true;
+			});
+
+			TokenType tokenType = findKeyword (hash, name, length);
+			SymbolTable::Symbol symbol = SymbolTable::noSymbol;
+			if (intern && tokenType == TokenType::NAME) {
+				symbol = m_symbolTable->intern (length <= nameBufferLength ? name : longName.data (), length, hash);
 			}
 
-			emit (Token (findKeyword (value), length));
+			emit (Token (tokenType, TokenError::NO_ERROR, length, false, symbol));
 			return;
 		}
 
-		// Parse punctuation:
+		// Parse punctuation, the longest match:
 		{
+			const PunctuationMatcher & matcher = punctuationMatcher ();
 			std::size_t length = 0;
-			std::u16string value;
-			TokenType punctuationToken;
-			while (m_scanner.la () > 0) {
-				TokenType t;
-				value += m_scanner.la ();
-				if ((t = findPunctuation (value)) == TokenType::END_OF_INPUT) {
-					break;
-				}
+			TokenType punctuationToken = TokenType::END_OF_INPUT;
+			int state = 0;
 
-				++ length;
-				m_scanner.accept ();
-				punctuationToken = t;
+			for (unsigned i = 0; (state = matcher.next (state, m_scanner.la (i))) >= 0; ++ i) {
+				if (matcher.accept (state) != TokenType::END_OF_INPUT) {
+					punctuationToken = matcher.accept (state);
+					length = i + 1;
+				}
 			}
+
 			if (length > 0) {
+				for (std::size_t i = 0; i < length; ++ i) {
+					m_scanner.accept ();
+				}
 				emit (Token (punctuationToken, length));
 				return;
 			}
@@ -254,22 +438,39 @@ namespace parser {
 
 		// Parse invalid characters:
 		{
-			std::size_t length = 0;
-			while (m_scanner.la () > ' ') {
-				++ length;
-				m_scanner.accept ();
-			}
+			std::size_t length = m_scanner.acceptWhile ([] (char16_t c) {
+				return c > ' ';
+			});
 
 			emit (Token (TokenType::INVALID_CHARACTERS, TokenError::UNEXPECTED_CHARACTERS, length));
 			return;
 		}
 	}
 
-	void Lexer :: emit (const Token & token) {
-		m_lookahead.push_back (token);
+	// Tokens are lexed with their length in characters, scanners with other length units
+	// measure them by their position:
+	template<typename ScannerType>
+	const Token & measure (const Token & token, ScannerType &, std::size_t &, std::true_type) {
+		return token;
+	}
+
+	template<typename ScannerType>
+	Token measure (const Token & token, ScannerType & scanner, std::size_t & tokenStart, std::false_type) {
+		std::size_t position = scanner.position ();
+		std::size_t length = position - tokenStart;
+		tokenStart = position;
+		return Token (token.type (), token.error (), length, token.hasLineBreak (), token.symbol ());
 	}
 
-	Token Lexer :: parseString (TokenType tokenType) {
+	template<typename ScannerType>
+	void BasicLexer<ScannerType> :: emit (const Token & token) {
+		m_lookahead.push_back (measure (token, m_scanner, m_tokenStart,
+			std::integral_constant<bool, ScannerType::charactersAreLengthUnits> ()));
+		++ m_tokenCount;
+	}
+
+	template<typename ScannerType>
+	Token BasicLexer<ScannerType> :: parseString (TokenType tokenType) {
 		char16_t quoteCharacter = m_scanner.la ();
 		std::size_t length = 1;
 		m_scanner.accept ();
@@ -305,6 +506,15 @@ namespace parser {
 
 			++ length;
 			m_scanner.accept ();
+
+			// Accept the characters up to the next special character in one go:
+			std::size_t count = m_scanner.acceptWhile ([quoteCharacter] (char16_t c) {
+				return c != quoteCharacter && c != '\\' && c != '\r' && c != '\n' && c != 0;
+			});
+			if (count > 0 && tokenType == TokenType::CHARACTER_CONSTANT) {
+				multipleCharacters = true;
+			}
+			length += count;
 		}
 
 		++ length;
@@ -319,7 +529,8 @@ namespace parser {
 		return Token (tokenType, length);
 	}
 
-	Token Lexer :: parseDecimal () {
+	template<typename ScannerType>
+	Token BasicLexer<ScannerType> :: parseDecimal () {
 		std::size_t length = 0;
 		bool hasIntegerPart = false;
 		bool hasDot = false;
@@ -327,27 +538,40 @@ namespace parser {
 		bool hasE = false;
 		bool hasExponent = false;
 
+		// The digits are only collected when the value is wanted:
+		bool decode = m_numericLiterals != nullptr;
+		internal::DecimalAccumulator value;
+
 		if (m_scanner.la () == '-') {
 			++ length;
 			m_scanner.accept ();
+			value.negative ();
 		}
 
-		while (isDigit (m_scanner.la ())) {
-			hasIntegerPart = true;
-			++ length;
-			m_scanner.accept ();
-		}
+		std::size_t integerDigits = !decode ? m_scanner.acceptWhile (isDigit) : m_scanner.acceptWhile ([&value] (char16_t c) {
+			if (!isDigit (c)) {
+				return false;
+			}
+			value.integerDigit (c);
+			return true;
+		});
+		hasIntegerPart = integerDigits > 0;
+		length += integerDigits;
 
 		if (m_scanner.la () == '.') {
 			hasDot = true;
 			++ length;
 			m_scanner.accept ();
 
-			while (isDigit (m_scanner.la ())) {
-				hasFraction = true;
-				++ length;
-				m_scanner.accept ();
-			}
+			std::size_t fractionDigits = !decode ? m_scanner.acceptWhile (isDigit) : m_scanner.acceptWhile ([&value] (char16_t c) {
+				if (!isDigit (c)) {
+					return false;
+				}
+				value.fractionDigit (c);
+				return true;
+			});
+			hasFraction = fractionDigits > 0;
+			length += fractionDigits;
 		}
 
 		if (m_scanner.la () == 'e' || m_scanner.la () == 'E') {
@@ -356,45 +580,71 @@ namespace parser {
 			m_scanner.accept ();
 
 			if (m_scanner.la () == '+' || m_scanner.la () == '-') {
+				if (m_scanner.la () == '-') {
+					value.negativeExponent ();
+				}
 				++ length;
 				m_scanner.accept ();
 			}
 
-			while (isDigit (m_scanner.la ())) {
-				hasExponent = true;
-				++ length;
-				m_scanner.accept ();
-			}
+			std::size_t exponentDigits = !decode ? m_scanner.acceptWhile (isDigit) : m_scanner.acceptWhile ([&value] (char16_t c) {
+				if (!isDigit (c)) {
+					return false;
+				}
+				value.exponentDigit (c);
+				return true;
+			});
+			hasExponent = exponentDigits > 0;
+			length += exponentDigits;
 		}
 
 		// Type flags:
 		bool isInt = hasIntegerPart && !hasDot && !hasE;
+		char16_t suffix = 0;
 		if (m_scanner.la () == 'f' || m_scanner.la () == 'F'
 				|| m_scanner.la () == 'd' || m_scanner.la () == 'D'
 				|| (isInt && (m_scanner.la () == 'l' || m_scanner.la () == 'L'))) {
 			++ length;
-			m_scanner.accept ();
+			suffix = m_scanner.accept ();
 		}
 
 		if ((!hasIntegerPart && !hasFraction) || (hasDot && !hasFraction) || (hasE && !hasExponent)) {
 			return Token (TokenType::DECIMAL_CONSTANT, TokenError::INVALID_NUMBER_FORMAT, length);
 		}
 
+		if (decode) {
+			m_numericLiterals->add (m_tokenCount, value.finish (isInt, suffix));
+		}
+
 		return Token (TokenType::DECIMAL_CONSTANT, length);
 	}
 
-	Token Lexer :: parseHex () {
+	template<typename ScannerType>
+	Token BasicLexer<ScannerType> :: parseHex () {
 		std::size_t length = 2;
 		m_scanner.accept ();
 		m_scanner.accept ();
 
-		while (isHexDigit (m_scanner.la ())) {
-			++ length;
-			m_scanner.accept ();
+		if (m_numericLiterals == nullptr) {
+			length += m_scanner.acceptWhile (isHexDigit);
+			return Token (TokenType::HEX_CONSTANT, length);
 		}
 
+		internal::HexAccumulator value;
+		length += m_scanner.acceptWhile ([&value] (char16_t c) {
+			if (!isHexDigit (c)) {
+				return false;
+			}
+			value.digit (c);
+			return true;
+		});
+
+		m_numericLiterals->add (m_tokenCount, value.finish ());
 		return Token (TokenType::HEX_CONSTANT, length);
 	}
 
+	template class BasicLexer<internal::Scanner>;
+	template class BasicLexer<internal::Utf8Scanner>;
+
 }	// namespace parser
 }	// namespace cyclone
@@ -1,9 +1,13 @@
 #ifndef CYCLONE_PARSER_LEXER_H__
 #define CYCLONE_PARSER_LEXER_H__
 
+#include <cassert>
+#include <cyclone/core/RingBuffer.h>
+#include <cyclone/core/SymbolTable.h>
 #include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/NumericLiteral.h>
+#include <cyclone/parser/Utf8Scanner.h>
 #include <cyclone/syntaxtree/Token.h>
-#include <vector>
 
 namespace cyclone {
 namespace parser {
@@ -14,12 +18,19 @@ namespace internal {
 		typedef cyclone::core::TextBuffer			TextBuffer;
 		typedef cyclone::core::TextBuffer::Iterator TextIterator;
 
+		// Token lengths are the number of accepted characters:
+		static const bool charactersAreLengthUnits = true;
+
+		// The lexer looks at most 6 characters ahead (an escape sequence in a string):
+		static const unsigned maxLookahead = 8;
+
 		Scanner (const TextBuffer buffer, const TextIterator rangeBegin, const TextIterator rangeEnd)
 			: m_textBuffer (buffer),
 			  m_bufferEnd (m_textBuffer.end ()),
 			  m_rangeBegin (m_textBuffer.at (rangeBegin.offset ())),
 			  m_rangeEnd (m_textBuffer.at (rangeEnd.offset ())),
-			  m_current (m_textBuffer.at (rangeBegin.offset ())) {
+			  m_current (m_textBuffer.at (rangeBegin.offset ())),
+			  m_lookahead (maxLookahead) {
 		}
 
 		Scanner (const Scanner & other)
@@ -27,7 +38,8 @@ namespace internal {
 			  m_bufferEnd (m_textBuffer.at (other.m_bufferEnd.offset ())),
 			  m_rangeBegin (m_textBuffer.at (other.m_rangeBegin.offset ())),
 			  m_rangeEnd (m_textBuffer.at (other.m_rangeEnd.offset ())),
-			  m_current (m_textBuffer.at (other.m_current.offset ())) {
+			  m_current (m_textBuffer.at (other.m_current.offset ())),
+			  m_lookahead (other.m_lookahead) {
 		}
 
 		Scanner & operator = (const Scanner & other) {
@@ -36,17 +48,17 @@ namespace internal {
 			m_rangeBegin = m_textBuffer.at (other.m_rangeBegin.offset ());
 			m_rangeEnd = m_textBuffer.at (other.m_rangeEnd.offset ());
 			m_current = m_textBuffer.at (other.m_current.offset ());
+			m_lookahead = other.m_lookahead;
 			return *this;
 		}
 
 		char16_t la (unsigned offset = 0) {
-			while (m_lookahead.size () <= offset) {
-				if (m_current == m_bufferEnd) {
-					m_lookahead.push_back (0);
-				} else {
-					m_lookahead.push_back (*m_current);
-					++ m_current;
-				}
+			// The ring never has to grow:
+			assert (offset < maxLookahead);
+
+			// Keep the common case small enough to be inlined into the lexer:
+			if (m_lookahead.size () <= offset) {
+				fill (offset);
 			}
 
 			return m_lookahead[offset];
@@ -56,58 +68,94 @@ namespace internal {
 			// Make sure there is at least one character to accept:
 			la ();
 
-			// Erase the first character:
-			char16_t v = m_lookahead[0];
-			m_lookahead.erase (m_lookahead.begin ());
-			return v;
+			return m_lookahead.pop_front ();
 		}
 
 		bool check (char16_t ch, unsigned offset = 0) {
 			return la (offset) == ch;
 		}
 
+		/**
+		 * Accepts characters for as long as the predicate holds and returns the number of
+		 * accepted characters. Once the lookahead is drained, the characters are read
+		 * directly from the leaves of the text buffer, only moving to the next leaf goes
+		 * through the iterator. The predicate must reject 0, which marks the end of input.
+		 */
+		template<typename Predicate>
+		std::size_t acceptWhile (Predicate predicate) {
+			std::size_t count = 0;
+
+			while (!m_lookahead.empty ()) {
+				if (!predicate (m_lookahead.front ())) {
+					return count;
+				}
+				m_lookahead.pop_front ();
+				++ count;
+			}
+
+			while (true) {
+				const char16_t * begin = m_current.spanData ();
+				const char16_t * end = begin + m_current.spanRemaining ();
+				const char16_t * p = begin;
+
+				while (p != end && predicate (*p)) {
+					++ p;
+				}
+
+				count += p - begin;
+				m_current.advance (p - begin);
+
+				if (p != end || begin == end) {
+					return count;
+				}
+			}
+		}
+
 		bool isRangeComplete () const {
 			std::size_t currentOffset = m_current.offset ();
-			for (char16_t la: m_lookahead) {
-				if (la != 0) {
-					-- currentOffset;
-				} else {
-					break;
-				}
+			for (std::size_t i = 0; i < m_lookahead.size () && m_lookahead[i] != 0; ++ i) {
+				-- currentOffset;
 			}
 			return currentOffset >= m_rangeEnd.offset ();
 		}
 
 	private:
 
-		TextBuffer				m_textBuffer;
-		TextIterator			m_bufferEnd;
-		TextIterator			m_rangeBegin;
-		TextIterator			m_rangeEnd;
-		TextIterator			m_current;
-		std::vector<char16_t>	m_lookahead;
+		void fill (unsigned offset) {
+			while (m_lookahead.size () <= offset) {
+				if (m_current == m_bufferEnd) {
+					m_lookahead.push_back (0);
+				} else {
+					m_lookahead.push_back (*m_current);
+					++ m_current;
+				}
+			}
+		}
+
+		TextBuffer							m_textBuffer;
+		TextIterator						m_bufferEnd;
+		TextIterator						m_rangeBegin;
+		TextIterator						m_rangeEnd;
+		TextIterator						m_current;
+		cyclone::core::RingBuffer<char16_t>	m_lookahead;
 	};
 }
 
-class Lexer {
+/**
+ * The lexer, templated on the scanner that provides the characters. Scanners present
+ * their input as UTF-16 code units and report a position in their own length unit, all
+ * lexers produce the same tokens for the same text.
+ */
+template<typename ScannerType>
+class BasicLexer {
 public:
 
-	typedef cyclone::core::TextBuffer			TextBuffer;
-	typedef cyclone::core::TextBuffer::Iterator TextIterator;
 	typedef cyclone::syntaxtree::Token			Token;
 	typedef cyclone::syntaxtree::TokenType		TokenType;
 
-	Lexer (const TextBuffer textBuffer, const TextIterator rangeBegin, const TextIterator rangeEnd)
-		: m_scanner (textBuffer, rangeBegin, rangeEnd) {
-	}
-
-	Lexer (const Lexer & other) : m_scanner (other.m_scanner) {
-	}
-
-	Lexer & operator = (const Lexer & other) {
-		m_scanner = other.m_scanner;
-		return *this;
-	}
+	// The parser looks past any number of whitespace and comment tokens, the token
+	// lookahead starts at this capacity and grows when needed:
+	static const unsigned initialLookahead = 16;
 
 	Token la (unsigned offset = 0);
 	Token accept ();
@@ -116,6 +164,19 @@ public:
 		return la (offset).type () == tokenType;
 	}
 
+protected:
+
+	// Names are interned in symbolTable when it is given, the values of numeric constants
+	// are decoded into numericLiterals when it is given:
+	BasicLexer (const ScannerType & scanner, cyclone::core::SymbolTable * symbolTable, NumericLiteralTable * numericLiterals)
+		: m_scanner (scanner),
+		  m_lookahead (initialLookahead),
+		  m_symbolTable (symbolTable),
+		  m_numericLiterals (numericLiterals),
+		  m_tokenCount (0),
+		  m_tokenStart (0) {
+	}
+
 private:
 
 	void next ();
@@ -125,8 +186,43 @@ private:
 	Token parseDecimal ();
 	Token parseHex ();
 
-	internal::Scanner	m_scanner;
-	std::vector<Token>	m_lookahead;
+	ScannerType							m_scanner;
+	cyclone::core::RingBuffer<Token>	m_lookahead;
+	cyclone::core::SymbolTable *		m_symbolTable;
+	NumericLiteralTable *				m_numericLiterals;
+	std::size_t							m_tokenCount;	// The number of emitted tokens, the index of the next one
+	std::size_t							m_tokenStart;	// The scanner position after the last token
+};
+
+/**
+ * Lexes a range of a text buffer, token lengths are in UTF-16 code units.
+ */
+class Lexer : public BasicLexer<internal::Scanner> {
+public:
+
+	typedef cyclone::core::TextBuffer			TextBuffer;
+	typedef cyclone::core::TextBuffer::Iterator TextIterator;
+
+	Lexer (const TextBuffer textBuffer, const TextIterator rangeBegin, const TextIterator rangeEnd,
+			cyclone::core::SymbolTable * symbolTable = nullptr, NumericLiteralTable * numericLiterals = nullptr)
+		: BasicLexer (internal::Scanner (textBuffer, rangeBegin, rangeEnd), symbolTable, numericLiterals) {
+	}
+};
+
+/**
+ * Lexes UTF-8 text in memory, for example a mapped file, without transcoding it first.
+ * The memory must outlive the lexer. Token lengths are in the given unit, invalid UTF-8
+ * bytes are read as U+FFFD and are one byte long.
+ */
+class Utf8Lexer : public BasicLexer<internal::Utf8Scanner> {
+public:
+
+	typedef internal::Utf8Scanner::LengthUnit	LengthUnit;
+
+	Utf8Lexer (const char * begin, const char * end, LengthUnit lengthUnit = LengthUnit::UTF16,
+			cyclone::core::SymbolTable * symbolTable = nullptr, NumericLiteralTable * numericLiterals = nullptr)
+		: BasicLexer (internal::Utf8Scanner (begin, end, lengthUnit), symbolTable, numericLiterals) {
+	}
 };
 
 }
@@ -0,0 +1,319 @@
+#include <cyclone/parser/NumericLiteral.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <locale>
+#include <sstream>
+
+namespace cyclone {
+namespace parser {
+namespace internal {
+
+	extern const std::uint64_t powersOfFive[651][2];
+
+	namespace {
+		const std::int64_t smallestPowerOfFive = -342;
+
+		// The IEEE formats, the constants follow "Number Parsing at a Gigabyte per Second"
+		// by Daniel Lemire:
+		struct Binary64 {
+			typedef double			Type;
+			typedef std::uint64_t	Bits;
+
+			static const int mantissaBits = 52;
+			static const int minimumExponent = -1023;
+			static const int infinitePower = 0x7ff;
+			static const int smallestPowerOfTen = -342;
+			static const int largestPowerOfTen = 308;
+			static const int minRoundToEven = -4;
+			static const int maxRoundToEven = 23;
+			static const int maxExactPowerOfTen = 22;
+		};
+
+		struct Binary32 {
+			typedef float			Type;
+			typedef std::uint32_t	Bits;
+
+			static const int mantissaBits = 23;
+			static const int minimumExponent = -127;
+			static const int infinitePower = 0xff;
+			static const int smallestPowerOfTen = -64;
+			static const int largestPowerOfTen = 38;
+			static const int minRoundToEven = -17;
+			static const int maxRoundToEven = 10;
+			static const int maxExactPowerOfTen = 10;
+		};
+
+		void multiply (std::uint64_t a, std::uint64_t b, std::uint64_t & high, std::uint64_t & low) {
+#ifdef __SIZEOF_INT128__
+			__extension__ typedef unsigned __int128 uint128;
+			uint128 product = uint128 (a) * b;
+			high = std::uint64_t (product >> 64);
+			low = std::uint64_t (product);
+#else
+			std::uint64_t aLow = a & 0xffffffff, aHigh = a >> 32;
+			std::uint64_t bLow = b & 0xffffffff, bHigh = b >> 32;
+			std::uint64_t ll = aLow * bLow, lh = aLow * bHigh, hl = aHigh * bLow, hh = aHigh * bHigh;
+			std::uint64_t middle = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+			high = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+			low = (middle << 32) | (ll & 0xffffffff);
+#endif
+		}
+
+		int leadingZeros (std::uint64_t value) {
+			int count = 0;
+			for (std::uint64_t bit = std::uint64_t (1) << 63; (value & bit) == 0; bit >>= 1) {
+				++ count;
+			}
+			return count;
+		}
+
+		/**
+		 * The Eisel-Lemire algorithm: multiplies the normalized mantissa by a truncated
+		 * 128-bit power of five. The product is always precise enough to round correctly
+		 * when the mantissa is exact, see "Fast Number Parsing Without Fallback" by Noble
+		 * Mushtak and Daniel Lemire. Returns the biased exponent and the mantissa without
+		 * the implicit bit, mantissa must not be 0.
+		 */
+		template<typename Format>
+		void computeFloat (std::uint64_t mantissa, std::int64_t q, std::uint64_t & resultMantissa, int & resultPower) {
+			if (mantissa == 0 || q < Format::smallestPowerOfTen) {
+				resultMantissa = 0;
+				resultPower = 0;
+				return;
+			}
+			if (q > Format::largestPowerOfTen) {
+				resultMantissa = 0;
+				resultPower = Format::infinitePower;
+				return;
+			}
+
+			int lz = leadingZeros (mantissa);
+			mantissa <<= lz;
+
+			const std::uint64_t * power = powersOfFive[q - smallestPowerOfFive];
+			std::uint64_t high, low;
+			multiply (mantissa, power[0], high, low);
+
+			// The low word of the power only matters when the bits below the result are all ones:
+			const std::uint64_t precisionMask = UINT64_MAX >> (Format::mantissaBits + 3);
+			if ((high & precisionMask) == precisionMask) {
+				std::uint64_t secondHigh, secondLow;
+				multiply (mantissa, power[1], secondHigh, secondLow);
+				low += secondHigh;
+				if (secondHigh > low) {
+					++ high;
+				}
+			}
+
+			int upperBit = int (high >> 63);
+			int shift = upperBit + 64 - Format::mantissaBits - 3;
+			std::uint64_t m = high >> shift;
+
+			// floor (log2 (10^q)) + 63:
+			int power2 = int (((std::int64_t (152170 + 65536) * q) >> 16) + 63) + upperBit - lz - Format::minimumExponent;
+
+			// Subnormals:
+			if (power2 <= 0) {
+				if (-power2 + 1 >= 64) {
+					resultMantissa = 0;
+					resultPower = 0;
+					return;
+				}
+				m >>= -power2 + 1;
+				m += m & 1;
+				m >>= 1;
+				resultMantissa = m;
+				resultPower = m < (std::uint64_t (1) << Format::mantissaBits) ? 0 : 1;
+				return;
+			}
+
+			// Exactly halfway between two floats, round to even:
+			if (low <= 1 && q >= Format::minRoundToEven && q <= Format::maxRoundToEven && (m & 3) == 1
+					&& (m << shift) == high) {
+				m &= ~std::uint64_t (1);
+			}
+
+			m += m & 1;
+			m >>= 1;
+			if (m >= (std::uint64_t (2) << Format::mantissaBits)) {
+				m = std::uint64_t (1) << Format::mantissaBits;
+				++ power2;
+			}
+			m &= ~(std::uint64_t (1) << Format::mantissaBits);
+
+			if (power2 >= Format::infinitePower) {
+				m = 0;
+				power2 = Format::infinitePower;
+			}
+
+			resultMantissa = m;
+			resultPower = power2;
+		}
+
+		template<typename Format>
+		typename Format::Type toFloat (std::uint64_t mantissa, int power2) {
+			typename Format::Bits bits = typename Format::Bits (mantissa | (std::uint64_t (power2) << Format::mantissaBits));
+			typename Format::Type result;
+			std::memcpy (&result, &bits, sizeof (result));
+			return result;
+		}
+
+		// Returns false when truncated digits make the result ambiguous:
+		template<typename Format>
+		bool decimalToBinary (std::uint64_t mantissa, std::int64_t q, bool truncated, typename Format::Type & result) {
+			typedef typename Format::Type Type;
+
+			// Clinger's fast path, both operands are exact:
+			if (!truncated && mantissa <= (std::uint64_t (2) << Format::mantissaBits)
+					&& q >= -Format::maxExactPowerOfTen && q <= Format::maxExactPowerOfTen) {
+				static const Type powersOfTen[] = {
+					1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+					1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+				};
+				result = q < 0 ? Type (mantissa) / powersOfTen[-q] : Type (mantissa) * powersOfTen[q];
+				return true;
+			}
+
+			std::uint64_t m;
+			int power2;
+			computeFloat<Format> (mantissa, q, m, power2);
+
+			// The exact value lies between mantissa and mantissa + 1:
+			if (truncated) {
+				std::uint64_t upperM;
+				int upperPower2;
+				computeFloat<Format> (mantissa + 1, q, upperM, upperPower2);
+				if (upperM != m || upperPower2 != power2) {
+					return false;
+				}
+			}
+
+			result = toFloat<Format> (m, power2);
+			return true;
+		}
+
+		template<typename T>
+		T parseClassic (const std::string & text) {
+			std::istringstream stream (text);
+			stream.imbue (std::locale::classic ());
+
+			T result = 0;
+			stream >> result;
+			return result;
+		}
+	}
+
+	double decimalToDouble (std::uint64_t mantissa, std::int64_t exponent) {
+		double result;
+		decimalToBinary<Binary64> (mantissa, exponent, false, result);
+		return result;
+	}
+
+	float decimalToFloat (std::uint64_t mantissa, std::int64_t exponent) {
+		float result;
+		decimalToBinary<Binary32> (mantissa, exponent, false, result);
+		return result;
+	}
+
+	DecimalAccumulator :: DecimalAccumulator ()
+		: m_negative (false),
+		  m_integerOverflow (false),
+		  m_truncated (false),
+		  m_negativeExponent (false),
+		  m_integer (0),
+		  m_mantissa (0),
+		  m_significantDigits (0),
+		  m_mantissaShift (0),
+		  m_fractionDigits (0),
+		  m_exponent (0) {
+	}
+
+	double DecimalAccumulator :: decodeFloatingPoint (bool single, bool & overflow) const {
+		std::int64_t exponent = m_negativeExponent ? -m_exponent : m_exponent;
+		std::int64_t q = exponent - m_mantissaShift;
+
+		double result = 0;
+		bool exact;
+		if (single) {
+			float value;
+			exact = decimalToBinary<Binary32> (m_mantissa, q, m_truncated, value);
+			result = value;
+		} else {
+			exact = decimalToBinary<Binary64> (m_mantissa, q, m_truncated, result);
+		}
+
+		// Fall back to the standard library with all digits, which is correctly rounded:
+		if (!exact) {
+			std::string text = m_digits + "e" + std::to_string (exponent - m_fractionDigits);
+			result = single ? parseClassic<float> (text) : parseClassic<double> (text);
+		}
+
+		overflow = std::isinf (result);
+		return m_negative ? -result : result;
+	}
+
+	NumericLiteral DecimalAccumulator :: finish (bool isInteger, char16_t suffix) const {
+		NumericLiteral literal;
+
+		switch (suffix) {
+			case 'f': case 'F':
+				literal.type = NumericType::FLOAT;
+				break;
+			case 'd': case 'D':
+				literal.type = NumericType::DOUBLE;
+				break;
+			case 'l': case 'L':
+				literal.type = NumericType::LONG;
+				break;
+			default:
+				literal.type = isInteger ? NumericType::INT : NumericType::DOUBLE;
+				break;
+		}
+
+		if (literal.isInteger ()) {
+			std::uint64_t limit = literal.type == NumericType::INT
+				? std::uint64_t (INT32_MAX) + m_negative
+				: std::uint64_t (INT64_MAX) + m_negative;
+
+			literal.overflow = m_integerOverflow || m_integer > limit;
+			literal.integerValue = std::int64_t (m_negative ? 0 - m_integer : m_integer);
+		} else {
+			literal.floatingValue = decodeFloatingPoint (literal.type == NumericType::FLOAT, literal.overflow);
+		}
+
+		return literal;
+	}
+
+	NumericLiteral HexAccumulator :: finish () const {
+		NumericLiteral literal;
+
+		literal.type = m_value >> 32 == 0 ? NumericType::INT : NumericType::LONG;
+		literal.overflow = m_overflow;
+		literal.integerValue = std::int64_t (m_value);
+		return literal;
+	}
+
+}	// namespace internal
+
+	void NumericLiteralTable :: add (std::size_t tokenIndex, const NumericLiteral & literal) {
+		// A copy of the lexer can scan the same tokens again:
+		if (!m_indices.empty () && tokenIndex <= m_indices.back ()) {
+			return;
+		}
+
+		m_indices.push_back (tokenIndex);
+		m_literals.push_back (literal);
+	}
+
+	const NumericLiteral * NumericLiteralTable :: find (std::size_t tokenIndex) const {
+		std::vector<std::size_t>::const_iterator it = std::lower_bound (m_indices.begin (), m_indices.end (), tokenIndex);
+
+		if (it == m_indices.end () || *it != tokenIndex) {
+			return nullptr;
+		}
+		return &m_literals[it - m_indices.begin ()];
+	}
+
+}	// namespace parser
+}	// namespace cyclone
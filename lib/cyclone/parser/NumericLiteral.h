@@ -0,0 +1,191 @@
+#ifndef CYCLONE_PARSER_NUMERICLITERAL_H__
+#define CYCLONE_PARSER_NUMERICLITERAL_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cyclone {
+namespace parser {
+
+enum class NumericType : std::uint8_t {
+	INT,
+	LONG,
+	FLOAT,
+	DOUBLE
+};
+
+/**
+ * The value of a DECIMAL_CONSTANT or HEX_CONSTANT token. Integers without a suffix are
+ * 32 bits wide, an l suffix makes them 64 bits wide. Hex constants are bit patterns:
+ * they are INT when they fit 32 bits and LONG when they fit 64 bits. Decimals with a
+ * fraction or an exponent are DOUBLE unless they have an f suffix, any literal with an
+ * f or d suffix is a FLOAT or DOUBLE. Overflow is flagged instead of reported as a token
+ * error, the value is then undefined for integers and infinite for floating point.
+ */
+struct NumericLiteral {
+	NumericLiteral () : type (NumericType::INT), overflow (false), integerValue (0), floatingValue (0) {
+	}
+
+	bool isInteger () const {
+		return type == NumericType::INT || type == NumericType::LONG;
+	}
+
+	NumericType		type;
+	bool			overflow;
+	std::int64_t	integerValue;
+	double			floatingValue;	// A FLOAT value is exactly representable as a double
+};
+
+namespace internal {
+	/**
+	 * Collects a decimal literal digit by digit while the lexer scans it. The first 19
+	 * significant digits are kept in a 64-bit mantissa, which is enough for the fast
+	 * path; longer literals also keep all of their digits for the slow path.
+	 */
+	class DecimalAccumulator {
+	public:
+		DecimalAccumulator ();
+
+		void negative () {
+			m_negative = true;
+		}
+
+		void integerDigit (char16_t c) {
+			unsigned digit = c - '0';
+
+			if (m_integer <= (UINT64_MAX - digit) / 10) {
+				m_integer = m_integer * 10 + digit;
+			} else {
+				m_integerOverflow = true;
+			}
+
+			significantDigit (digit, false);
+		}
+
+		void fractionDigit (char16_t c) {
+			significantDigit (c - '0', true);
+		}
+
+		void negativeExponent () {
+			m_negativeExponent = true;
+		}
+
+		void exponentDigit (char16_t c) {
+			// Anything beyond this is zero or infinite anyway:
+			if (m_exponent < 100000) {
+				m_exponent = m_exponent * 10 + (c - '0');
+			}
+		}
+
+		// The suffix is 0 when the literal has none, isInteger when it has no fraction or exponent:
+		NumericLiteral finish (bool isInteger, char16_t suffix) const;
+
+	private:
+
+		static const int maxMantissaDigits = 19;
+
+		void significantDigit (unsigned digit, bool fraction) {
+			if (fraction) {
+				++ m_fractionDigits;
+			}
+
+			// Leading zeros:
+			if (m_mantissa == 0 && digit == 0 && m_digits.empty ()) {
+				if (fraction) {
+					++ m_mantissaShift;
+				}
+				return;
+			}
+
+			if (m_significantDigits < maxMantissaDigits) {
+				m_mantissa = m_mantissa * 10 + digit;
+				++ m_significantDigits;
+				if (fraction) {
+					++ m_mantissaShift;
+				}
+				return;
+			}
+
+			if (m_digits.empty ()) {
+				m_digits = std::to_string (m_mantissa);
+			}
+			m_digits += char ('0' + digit);
+			m_truncated = m_truncated || digit != 0;
+			if (!fraction) {
+				-- m_mantissaShift;
+			}
+		}
+
+		double decodeFloatingPoint (bool single, bool & overflow) const;
+
+		bool			m_negative;
+		bool			m_integerOverflow;
+		bool			m_truncated;
+		bool			m_negativeExponent;
+		std::uint64_t	m_integer;
+		std::uint64_t	m_mantissa;
+		int				m_significantDigits;
+		std::int64_t	m_mantissaShift;	// mantissa * 10^(exponent - shift) is the value, give or take the truncated digits
+		std::int64_t	m_fractionDigits;
+		std::int64_t	m_exponent;
+		std::string		m_digits;			// All significant digits, once there are more than fit the mantissa
+	};
+
+	class HexAccumulator {
+	public:
+		HexAccumulator () : m_value (0), m_overflow (false) {
+		}
+
+		void digit (char16_t c) {
+			unsigned digit = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+			m_overflow = m_overflow || (m_value >> 60) != 0;
+			m_value = (m_value << 4) | digit;
+		}
+
+		NumericLiteral finish () const;
+
+	private:
+
+		std::uint64_t	m_value;
+		bool			m_overflow;
+	};
+
+	// Correctly rounded mantissa * 10^exponent:
+	double decimalToDouble (std::uint64_t mantissa, std::int64_t exponent);
+	float decimalToFloat (std::uint64_t mantissa, std::int64_t exponent);
+}
+
+/**
+ * The values of the numeric tokens of a lexer, keyed by the index of the token in the
+ * token sequence of the lexer (counting whitespace and comments). Indices are added in
+ * increasing order, lookups are binary searches.
+ */
+class NumericLiteralTable {
+public:
+
+	void add (std::size_t tokenIndex, const NumericLiteral & literal);
+
+	// Returns nullptr when the token has no value:
+	const NumericLiteral * find (std::size_t tokenIndex) const;
+
+	std::size_t size () const {
+		return m_indices.size ();
+	}
+
+	void clear () {
+		m_indices.clear ();
+		m_literals.clear ();
+	}
+
+private:
+
+	std::vector<std::size_t>		m_indices;
+	std::vector<NumericLiteral>		m_literals;
+};
+
+}	// namespace parser
+}	// namespace cyclone
+
+#endif	// CYCLONE_PARSER_NUMERICLITERAL_H__
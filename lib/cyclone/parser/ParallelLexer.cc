@@ -0,0 +1,157 @@
+#include <cyclone/parser/ParallelLexer.h>
+#include <cyclone/parser/Lexer.h>
+#include <algorithm>
+#include <exception>
+#include <future>
+
+namespace cyclone {
+namespace parser {
+
+	using namespace cyclone::core;
+	using namespace cyclone::syntaxtree;
+
+	ParallelLexer :: ParallelLexer (ThreadPool & threadPool, std::size_t chunkLength, SymbolTable * symbolTable)
+		: m_threadPool (threadPool),
+		  m_chunkLength (chunkLength > 0 ? chunkLength : 1),
+		  m_symbolTable (symbolTable),
+		  m_chunkCount (0),
+		  m_repairedChunkCount (0) {
+	}
+
+	std::vector<std::size_t> ParallelLexer :: splitPoints (const TextBuffer & textBuffer) const {
+		std::vector<std::size_t> points (1, 0);
+		std::size_t length = textBuffer.length ();
+
+		// Looks for the first non-blank character of a line after every chunkLength characters.
+		// Lines starting with '*' are skipped, they are likely inside a comment:
+		for (std::size_t nominal = m_chunkLength; nominal < length; nominal += m_chunkLength) {
+			if (nominal <= points.back ()) {
+				continue;
+			}
+
+			std::size_t limit = std::min (length, nominal + m_chunkLength);
+			TextBuffer::Iterator it = textBuffer.at (nominal);
+			bool lineStart = false;
+
+			for (std::size_t offset = nominal; offset < limit; ++ offset, ++ it) {
+				char16_t c = *it;
+				if (c == '\n') {
+					lineStart = true;
+				} else if (c == ' ' || c == '\t' || c == '\r') {
+					continue;
+				} else if (lineStart && c != '*') {
+					points.push_back (offset);
+					break;
+				} else {
+					lineStart = false;
+				}
+			}
+		}
+
+		return points;
+	}
+
+	void ParallelLexer :: lexChunk (const TextBuffer & textBuffer, Chunk & chunk) const {
+		Lexer lexer (textBuffer, textBuffer.at (chunk.begin), textBuffer.at (chunk.end), m_symbolTable);
+		std::size_t offset = chunk.begin;
+
+		for (Token token = lexer.accept (); token.type () != TokenType::END_OF_INPUT; token = lexer.accept ()) {
+			chunk.tokens.push_back (token);
+			chunk.offsets.push_back (offset);
+			offset += token.length ();
+		}
+	}
+
+	std::vector<ParallelLexer::Token> ParallelLexer :: lex (const TextBuffer & textBuffer) {
+		std::vector<std::size_t> points = splitPoints (textBuffer);
+		std::vector<Chunk> chunks (points.size ());
+		std::vector<std::future<void>> results;
+		results.reserve (chunks.size ());
+
+		// The tasks refer to the chunks, all of them must be done before an exception
+		// leaves, the first one is rethrown then:
+		std::exception_ptr error;
+		try {
+			for (std::size_t i = 0; i < chunks.size (); ++ i) {
+				Chunk & chunk = chunks[i];
+				chunk.begin = points[i];
+				chunk.end = i + 1 < points.size () ? points[i + 1] : textBuffer.length ();
+				results.push_back (m_threadPool.submit ([this, &textBuffer, &chunk] () { lexChunk (textBuffer, chunk); }));
+			}
+		} catch (...) {
+			error = std::current_exception ();
+		}
+
+		for (std::future<void> & result: results) {
+			try {
+				result.get ();
+			} catch (...) {
+				if (!error) {
+					error = std::current_exception ();
+				}
+			}
+		}
+		if (error) {
+			std::rethrow_exception (error);
+		}
+
+		std::size_t tokenCount = 0;
+		for (const Chunk & chunk: chunks) {
+			tokenCount += chunk.tokens.size ();
+		}
+
+		// Merge the chunks. offset is the end of the last merged token, the serial lexer
+		// starts its next token there:
+		std::vector<Token> tokens;
+		tokens.reserve (tokenCount);
+		std::size_t offset = 0;
+
+		m_chunkCount = chunks.size ();
+		m_repairedChunkCount = 0;
+
+		for (const Chunk & chunk: chunks) {
+			if (offset != chunk.begin) {
+				++ m_repairedChunkCount;
+			}
+
+			if (offset >= chunk.end) {
+				// The chunk is covered by a token of an earlier chunk:
+				continue;
+			}
+
+			std::size_t index = std::lower_bound (chunk.offsets.begin (), chunk.offsets.end (), offset) - chunk.offsets.begin ();
+
+			if (index == chunk.offsets.size () || chunk.offsets[index] != offset) {
+				// The chunk started inside a token, relex until a token starts at the same
+				// position as in the chunk:
+				Lexer lexer (textBuffer, textBuffer.at (offset), textBuffer.at (chunk.end), m_symbolTable);
+
+				while (true) {
+					while (index < chunk.offsets.size () && chunk.offsets[index] < offset) {
+						++ index;
+					}
+					if (index < chunk.offsets.size () && chunk.offsets[index] == offset) {
+						break;
+					}
+
+					Token token = lexer.accept ();
+					if (token.type () == TokenType::END_OF_INPUT) {
+						index = chunk.tokens.size ();
+						break;
+					}
+					tokens.push_back (token);
+					offset += token.length ();
+				}
+			}
+
+			if (index < chunk.tokens.size ()) {
+				tokens.insert (tokens.end (), chunk.tokens.begin () + index, chunk.tokens.end ());
+				offset = chunk.offsets.back () + chunk.tokens.back ().length ();
+			}
+		}
+
+		return tokens;
+	}
+
+}	// namespace parser
+}	// namespace cyclone
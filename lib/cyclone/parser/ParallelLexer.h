@@ -0,0 +1,68 @@
+#ifndef CYCLONE_PARSER_PARALLELLEXER_H__
+#define CYCLONE_PARSER_PARALLELLEXER_H__
+
+#include <vector>
+#include <cyclone/core/SymbolTable.h>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/ThreadPool.h>
+#include <cyclone/syntaxtree/Token.h>
+
+namespace cyclone {
+namespace parser {
+
+/**
+ * Lexes a large buffer in chunks on a thread pool. Chunks start at the first non-blank
+ * character of a line, which usually is a token boundary. When it isn't (the line is inside
+ * a comment or string), merging notices that the previous chunk's last token runs past the
+ * split point and relexes serially from the end of that token until it meets a token
+ * boundary of the chunk again. The result is always the token stream of the serial Lexer,
+ * without the END_OF_INPUT token.
+ */
+class ParallelLexer {
+public:
+
+	typedef cyclone::core::TextBuffer		TextBuffer;
+	typedef cyclone::core::ThreadPool		ThreadPool;
+	typedef cyclone::syntaxtree::Token		Token;
+	typedef cyclone::syntaxtree::TokenType	TokenType;
+
+	static const std::size_t defaultChunkLength = 256 * 1024;
+
+	// Names are interned in symbolTable when it is given:
+	explicit ParallelLexer (ThreadPool & threadPool, std::size_t chunkLength = defaultChunkLength, cyclone::core::SymbolTable * symbolTable = nullptr);
+
+	std::vector<Token> lex (const TextBuffer & textBuffer);
+
+	// Statistics of the last run:
+	std::size_t chunkCount () const {
+		return m_chunkCount;
+	}
+
+	// Chunks that didn't start at a token boundary:
+	std::size_t repairedChunkCount () const {
+		return m_repairedChunkCount;
+	}
+
+private:
+
+	struct Chunk {
+		std::size_t					begin;
+		std::size_t					end;
+		std::vector<Token>			tokens;
+		std::vector<std::size_t>	offsets;
+	};
+
+	std::vector<std::size_t> splitPoints (const TextBuffer & textBuffer) const;
+	void lexChunk (const TextBuffer & textBuffer, Chunk & chunk) const;
+
+	ThreadPool &					m_threadPool;
+	std::size_t						m_chunkLength;
+	cyclone::core::SymbolTable *	m_symbolTable;
+	std::size_t						m_chunkCount;
+	std::size_t						m_repairedChunkCount;
+};
+
+}	// namespace parser
+}	// namespace cyclone
+
+#endif	// CYCLONE_PARSER_PARALLELLEXER_H__
@@ -1,4 +1,6 @@
 #include <cyclone/parser/Parser.h>
+#include <CycloneConfig.h>
+#include <vector>
 
 namespace cyclone {
 namespace parser {
@@ -6,21 +8,206 @@ namespace parser {
 	namespace internal {
 		RuleScope :: RuleScope (Parser & parser, NodeType nodeType)
 			: m_parser (parser),
-			  m_target (std::make_shared<Node> (nodeType)) {
-			m_parser.m_scopes.push (this);
+			  m_finished (false) {
+			// Before the node starts, the destructor doesn't run when this throws:
+			m_parser.poll ();
+			m_parser.m_builder.startNode (nodeType);
+
+#ifdef CYCLONE_PARSER_PROFILING
+			if (m_parser.m_profiler != nullptr) {
+				m_parser.m_profiler->enter (nodeType);
+			}
+#endif
 		}
 
 		RuleScope :: ~RuleScope () {
-			m_parser.m_scopes.pop ();
+			if (!m_finished) {
+				finishNode ();
+			}
+		}
+
+		std::shared_ptr<RuleScope::Node> RuleScope :: finish () {
+			finishNode ();
+
+			if (&m_parser.m_builder != &m_parser.m_nodeBuilder) {
+				return nullptr;
+			}
+			return m_parser.m_nodeBuilder.lastNode ();
 		}
 
+		void RuleScope :: finishNode () {
+#ifdef CYCLONE_PARSER_PROFILING
+			if (m_parser.m_profiler != nullptr) {
+				m_parser.m_profiler->leave ();
+			}
+#endif
+
+			m_parser.m_builder.finishNode ();
+			m_finished = true;
+		}
+
+
+		/**
+		 * Parses the body by lexing its range of the text, its offsets start at the body.
+		 * Nested bodies are lazy again, and share the text.
+		 */
+		class LazyNamespaceBody : public cyclone::syntaxtree::LazyNode {
+		public:
+
+			LazyNamespaceBody (const Parser::TextBuffer & textBuffer, std::size_t offset, std::size_t length)
+				: LazyNode (length), m_textBuffer (textBuffer), m_offset (offset) {
+			}
+
+		protected:
+
+			virtual std::shared_ptr<Parser::Node> parse () const {
+				// No token of the body runs into the '}' after it:
+				Lexer lexer (m_textBuffer, m_textBuffer.at (m_offset), m_textBuffer.at (m_offset + length ()));
+				Parser parser (lexer);
+				parser.m_lazyText = &m_textBuffer;
+				parser.m_lazyTextOffset = m_offset;
+				return parser.parseNamespaceBody ();
+			}
+
+		private:
+
+			Parser::TextBuffer	m_textBuffer;
+			std::size_t			m_offset;
+		};
+	}
+
+	Parser :: Parser (const TokenSource & lexer)
+		: m_lexer (lexer), m_trivia (0), m_offset (0), m_lazyText (nullptr), m_lazyTextOffset (0),
+		  m_cancellation (nullptr), m_pollCountdown (cancellationPollInterval), m_profiler (nullptr), m_builder (m_nodeBuilder) {
 	}
 
-	Parser :: Parser (Lexer & lexer) : m_lexer (lexer) {
+	Parser :: Parser (const TokenSource & lexer, TreeBuilder & builder)
+		: m_lexer (lexer), m_trivia (0), m_offset (0), m_lazyText (nullptr), m_lazyTextOffset (0),
+		  m_cancellation (nullptr), m_pollCountdown (cancellationPollInterval), m_profiler (nullptr), m_builder (builder) {
 	}
 
+	const unsigned Parser::cancellationPollInterval;
+
 	Parser::SyntaxTree Parser :: parse () {
-		return SyntaxTree (parseCompilationUnit ());
+		try {
+			return SyntaxTree (parseCompilationUnit (), true, m_lazyText != nullptr);
+		} catch (const ParseCancelled &) {
+			// The rule scopes have finished their nodes, the last one is the root:
+			return SyntaxTree (m_nodeBuilder.lastNode (), false, m_lazyText != nullptr);
+		}
+	}
+
+	Parser::SyntaxTree Parser :: parseLazily (const TextBuffer & textBuffer) {
+		Lexer lexer (textBuffer, textBuffer.begin (), textBuffer.end ());
+		Parser parser (lexer);
+		parser.m_lazyText = &textBuffer;
+		return parser.parse ();
+	}
+
+	namespace {
+		struct PathEntry {
+			std::shared_ptr<Parser::Node>	parent;
+			unsigned						index;
+			std::size_t						offset;		// Of the child
+		};
+
+		/**
+		 * Whether the node at offset can be reparsed on its own after edit: the parser must
+		 * get to it in the same state, which holds when the tokens up to and including its
+		 * first significant token (the NAMESPACE or USING keyword, which made the parser
+		 * enter it) haven't seen the edit. The edit must also end inside the node.
+		 */
+		bool canReparse (const Parser::Node & node, std::size_t offset, const Parser::TextEdit & edit) {
+			if (edit.oldEnd () >= offset + node.length ()) {
+				return false;
+			}
+
+			for (unsigned i = 0; i < node.nodeCount (); ++ i) {
+				std::shared_ptr<Parser::NodeBase> child = node.node (i);
+				offset += child->length ();
+
+				if (!child->isTerminal ()) {
+					return false;
+				}
+				if (!SignificantLexer::isTrivia (std::static_pointer_cast<Parser::Terminal> (child)->token ().type ())) {
+					// A token may have read ahead of its end:
+					return offset + internal::Scanner::maxLookahead <= edit.offset;
+				}
+			}
+			return false;
+		}
+	}
+
+	Parser::SyntaxTree Parser :: reparse (const SyntaxTree & tree, const TextBuffer & textBuffer, const TextEdit & edit) {
+		// Without a complete tree there is nothing to share:
+		if (!tree.isComplete () || !tree.root ()) {
+			Lexer lexer (textBuffer, textBuffer.begin (), textBuffer.end ());
+			Parser parser (lexer);
+			return parser.parse ();
+		}
+
+		// A reparsed node would have eager bodies among lazy ones:
+		if (tree.isLazy ()) {
+			return parseLazily (textBuffer);
+		}
+
+		// The path to the innermost node that contains the edit:
+		std::vector<PathEntry> path;
+		std::shared_ptr<Node> node = tree.root ();
+		std::size_t offset = 0;
+
+		while (true) {
+			unsigned i = 0;
+			for (; i < node->nodeCount (); ++ i) {
+				std::size_t length = node->node (i)->length ();
+				if (edit.offset < offset + length) {
+					break;
+				}
+				offset += length;
+			}
+
+			if (i == node->nodeCount () || !node->node (i)->isNode ()) {
+				break;
+			}
+
+			PathEntry entry;
+			entry.parent = node;
+			entry.index = i;
+			entry.offset = offset;
+			path.push_back (entry);
+			node = std::static_pointer_cast<Node> (node->node (i));
+		}
+
+		// Reparse the innermost declaration that ends at the same token boundary as before:
+		for (std::size_t depth = path.size (); depth > 0; -- depth) {
+			const PathEntry & entry = path[depth - 1];
+			const Node & old = static_cast<const Node &> (*entry.parent->node (entry.index));
+
+			if ((old.type () != NodeType::NAMESPACE && old.type () != NodeType::USING) || !canReparse (old, entry.offset, edit)) {
+				continue;
+			}
+
+			Lexer lexer (textBuffer, textBuffer.at (entry.offset), textBuffer.end ());
+			Parser parser (lexer);
+			std::shared_ptr<NodeBase> result = old.type () == NodeType::NAMESPACE ? parser.parseNamespace () : parser.parseUsing ();
+
+			if (result->length () != old.length () + edit.delta ()) {
+				continue;
+			}
+
+			// Copy the path to it, everything else is shared with the old tree:
+			for (; depth > 0; -- depth) {
+				const PathEntry & parent = path[depth - 1];
+				std::shared_ptr<Node> copy = std::make_shared<Node> (*parent.parent);
+				copy->replaceNode (parent.index, result);
+				result = copy;
+			}
+			return SyntaxTree (std::static_pointer_cast<Node> (result));
+		}
+
+		Lexer lexer (textBuffer, textBuffer.begin (), textBuffer.end ());
+		Parser parser (lexer);
+		return parser.parse ();
 	}
 
 	Parser::Result Parser :: parseCompilationUnit () {
@@ -31,7 +218,7 @@ namespace parser {
 		// Accept the end of input token:
 		expect (TokenType :: END_OF_INPUT);
 
-		return scope.get ();
+		return scope.finish ();
 	}
 
 	Parser::Result Parser :: parseNamespace () {
@@ -39,15 +226,17 @@ namespace parser {
 
 		expect (TokenType::NAMESPACE);
 
-		add (parseScopedName ());
+		parseScopedName ();
 
-		expect (TokenType::LEFT_CURLY);
-
-		parseNamespaceContent ();
+		if (expect (TokenType::LEFT_CURLY) && m_lazyText != nullptr) {
+			skipNamespaceBody ();
+		} else {
+			parseNamespaceContent ();
+		}
 
 		expect (TokenType :: RIGHT_CURLY);
 
-		return scope.get ();
+		return scope.finish ();
 	}
 
 	Parser::Result Parser :: parseUsing () {
@@ -55,7 +244,7 @@ namespace parser {
 
 		expect (TokenType::USING);
 
-		add (parseScopedName ());
+		parseScopedName ();
 
 		if (check (TokenType::ASSIGN)) {
 			accept ();
@@ -65,7 +254,7 @@ namespace parser {
 
 		expect (TokenType::SEMICOLON);
 
-		return scope.get ();
+		return scope.finish ();
 	}
 
 	Parser::Result Parser :: parseScopedName () {
@@ -78,78 +267,112 @@ namespace parser {
 			expect (TokenType::NAME);
 		}
 
-		return scope.get ();
+		return scope.finish ();
 	}
 
 
+	Parser::Result Parser :: parseNamespaceBody () {
+		RuleScope scope (*this, NodeType::NAMESPACE_BODY);
+
+		parseNamespaceContent ();
+
+		// What the namespace would have as errors before its '}':
+		if (!check (TokenType::END_OF_INPUT)) {
+#ifdef CYCLONE_PARSER_PROFILING
+			if (m_profiler != nullptr) {
+				m_profiler->recovery ();
+			}
+#endif
+			recover ({ });
+		}
+		addTrivia (m_lexer.la ().leadingTrivia.end);
+
+		return scope.finish ();
+	}
+
+	void Parser :: skipNamespaceBody () {
+		// The body runs from the end of the '{' to the start of the matching '}':
+		std::size_t begin = m_offset;
+		std::size_t depth = 0;
+
+		while (!check (TokenType::END_OF_INPUT)) {
+			poll ();
+
+			if (check (TokenType::RIGHT_CURLY)) {
+				if (depth == 0) {
+					break;
+				}
+				-- depth;
+			} else if (check (TokenType::LEFT_CURLY)) {
+				++ depth;
+			}
+
+			skipTrivia (m_lexer.la ().leadingTrivia.end);
+			SignificantToken token = m_lexer.accept ();
+			m_offset += token.token.length ();
+			m_trivia = token.trailingTrivia.begin;
+		}
+		skipTrivia (m_lexer.la ().leadingTrivia.end);
+
+		m_nodeBuilder.addNode (std::make_shared<internal::LazyNamespaceBody> (*m_lazyText, m_lazyTextOffset + begin, m_offset - begin));
+	}
+
 	void Parser :: parseNamespaceContent () {
 		while (true) {
 			if (check (TokenType::USING)) {
-				add (parseUsing ());
+				parseUsing ();
 			} else if (check (TokenType::NAMESPACE)) {
-				add (parseNamespace ());
+				parseNamespace ();
 			} else {
 				break;
 			}
 		}
 	}
 
-	bool Parser :: isNonSignificant (TokenType tokenType) {
-		return tokenType == TokenType :: WHITESPACE
-			|| tokenType == TokenType :: SINGLE_LINE_COMMENT
-			|| tokenType == TokenType :: MULTI_LINE_COMMENT
-			|| tokenType == TokenType :: INVALID_CHARACTERS;
-	}
-
-	Parser::Node * Parser :: node () const {
-		return m_scopes.top ()->node ();
-	}
-
 	bool Parser :: check (TokenType tokenType) {
 		// See if the next significant token is of the given type:
-		unsigned i = 0;
+		return m_lexer.check (tokenType);
+	}
 
-		while (isNonSignificant (m_lexer.la (i).type ())) {
-			++ i;
-		}
+	bool Parser :: expect (TokenType tokenType) {
+		if (!check (tokenType)) {
+			m_builder.error (tokenType, nextTokenOffset ());
 
-		return m_lexer.la (i).type () == tokenType;
-	}
+#ifdef CYCLONE_PARSER_PROFILING
+			if (m_profiler != nullptr) {
+				m_profiler->recovery ();
+			}
+#endif
+		}
 
-	void Parser :: expect (TokenType tokenType) {
 		int n = 0;
 		while (!check (tokenType)) {
+			poll ();
+
 			// Emit an error node:
 
 			// Break at end of input:
 			if (check (TokenType::END_OF_INPUT)) {
-				add (recover ({ }));
-				return;
+				recover ({ });
+				return false;
 			}
 
 			// Break at a semicolon:
 			if (check (TokenType::SEMICOLON)) {
-				add (recover ({ TokenType::SEMICOLON }));
-				return;
+				recover ({ TokenType::SEMICOLON });
+				return false;
 			}
 
 			// Break after parsing 50 tokens:
 			if (n >= 50) {
-				add (std::make_shared<Node> (NodeType::ERROR));
-				return;
+				RuleScope scope (*this, NodeType::ERROR);
+				return false;
 			}
 
 			// Break at a newline:
-			unsigned i = 0;
-			while (true) {
-				if (m_lexer.la (i).type () == TokenType::WHITESPACE && m_lexer.la (i).hasLineBreak ()) {
-					add (std::make_shared<Node> (NodeType::ERROR));
-					return;
-				}
-				if (!isNonSignificant (m_lexer.la (i).type ())) {
-					break;
-				}
-				++ i;
+			if (m_lexer.la ().hasLineBreakBefore) {
+				RuleScope scope (*this, NodeType::ERROR);
+				return false;
 			}
 
 			// Accept the next token in an error:
@@ -157,40 +380,75 @@ namespace parser {
 				RuleScope scope (*this, NodeType::ERROR);
 
 				accept ();
-
-				add (scope.get ());
 			}
 
 			++ n;
 		}
 		accept ();
+		return true;
 	}
 
 	void Parser :: accept () {
-		// Accept all tokens up to and including the next significant token:
-		while (true) {
-			Token token = m_lexer.accept ();
-			node ()->addNode (std::make_shared<Terminal> (token));
-			if (!isNonSignificant (token.type ())) {
-				break;
+		// Add the trivia up to the next significant token, then the token:
+		SignificantToken token = m_lexer.accept ();
+
+		addTrivia (token.leadingTrivia.end);
+		m_builder.token (token.token, m_offset);
+		m_offset += token.token.length ();
+
+#ifdef CYCLONE_PARSER_PROFILING
+		if (m_profiler != nullptr) {
+			m_profiler->token ();
+		}
+#endif
+
+		m_trivia = token.trailingTrivia.begin;
+	}
+
+	void Parser :: addTrivia (std::size_t end) {
+		for (; m_trivia < end; ++ m_trivia) {
+			const Token & trivia = m_lexer.trivia (m_trivia);
+			m_builder.token (trivia, m_offset);
+			m_offset += trivia.length ();
+
+#ifdef CYCLONE_PARSER_PROFILING
+			if (m_profiler != nullptr) {
+				m_profiler->token ();
 			}
+#endif
 		}
 	}
 
-	Parser::Result Parser :: recover (std::initializer_list<TokenType> validTokenTypes) {
+	std::size_t Parser :: nextTokenOffset () {
+		std::size_t offset = m_offset;
+		for (std::size_t i = m_trivia; i < m_lexer.la ().leadingTrivia.end; ++ i) {
+			offset += m_lexer.trivia (i).length ();
+		}
+		return offset;
+	}
+
+	void Parser :: skipTrivia (std::size_t end) {
+		for (; m_trivia < end; ++ m_trivia) {
+			m_offset += m_lexer.trivia (m_trivia).length ();
+		}
+	}
+
+	void Parser :: recover (std::initializer_list<TokenType> validTokenTypes) {
 		RuleScope scope (*this, NodeType::ERROR);
 
 		while (true) {
 			if (check (TokenType::END_OF_INPUT)) {
-				return scope.get ();
+				return;
 			}
 
 			for (TokenType tt: validTokenTypes) {
 				if (check (tt)) {
-					return scope.get ();
+					return;
 				}
 			}
 
+			poll ();
+
 			accept ();
 		}
 	}
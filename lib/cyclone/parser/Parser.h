@@ -3,11 +3,16 @@
 
 #include <string>
 #include <memory>
-#include <stack>
+#include <stdexcept>
+#include <cyclone/core/CancellationToken.h>
+#include <cyclone/core/TextEdit.h>
 #include <cyclone/syntaxtree/SyntaxTree.h>
 #include <cyclone/syntaxtree/Token.h>
 #include <cyclone/syntaxtree/Node.h>
+#include <cyclone/syntaxtree/TreeBuilder.h>
 #include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/RuleProfiler.h>
+#include <cyclone/parser/SignificantLexer.h>
 
 namespace cyclone {
 namespace parser {
@@ -16,6 +21,12 @@ class Parser;
 
 namespace internal {
 
+	class LazyNamespaceBody;
+
+	/**
+	 * Starts a node of the tree, and finishes it when finish () is called or the scope is
+	 * left.
+	 */
 	class RuleScope {
 	public:
 
@@ -25,13 +36,8 @@ namespace internal {
 		RuleScope (Parser & parser, NodeType nodeType);
 		~RuleScope ();
 
-		Node * node () const {
-			return m_target.get ();
-		}
-
-		std::shared_ptr<Node> get () const {
-			return m_target;
-		}
+		// The node when the parser builds a tree of Node objects, null otherwise:
+		std::shared_ptr<Node> finish ();
 
 		Parser & parser () const {
 			return m_parser;
@@ -39,11 +45,24 @@ namespace internal {
 
 	private:
 
-		Parser &				m_parser;
-		std::shared_ptr<Node>	m_target;
+		void finishNode ();
+
+		Parser &	m_parser;
+		bool		m_finished;
 	};
 }
 
+/**
+ * Thrown by the parse methods when the cancellation token of the parser is cancelled.
+ * The builder has finished all the nodes that were started.
+ */
+class ParseCancelled : public std::runtime_error {
+public:
+
+	ParseCancelled () : std::runtime_error ("Parse cancelled") {
+	}
+};
+
 class Parser {
 public:
 
@@ -54,13 +73,62 @@ public:
 	typedef cyclone::syntaxtree::NodeBase	NodeBase;
 	typedef cyclone::syntaxtree::Terminal	Terminal;
 	typedef cyclone::syntaxtree::Node		Node;
+	typedef cyclone::syntaxtree::TreeBuilder	TreeBuilder;
+	typedef cyclone::syntaxtree::NodeBuilder	NodeBuilder;
 
 	using Result = std::shared_ptr<Node>;
 
-	Parser (Lexer & lexer);
+	typedef cyclone::core::TextBuffer		TextBuffer;
+	typedef cyclone::core::TextEdit			TextEdit;
+	typedef cyclone::core::CancellationToken	CancellationToken;
+
+	// Rule boundaries and error recovery steps between polls of the cancellation token:
+	static const unsigned cancellationPollInterval = 64;
 
+	// The lexer is a Lexer, or a Utf8Lexer for UTF-8 in memory. Builds a tree of Node
+	// objects, returned by the parse methods:
+	Parser (const TokenSource & lexer);
+
+	// Reports the tree and the errors to builder, the parse methods return null:
+	Parser (const TokenSource & lexer, TreeBuilder & builder);
+
+	/**
+	 * The parse methods poll token at rule boundaries and in error recovery, and throw
+	 * ParseCancelled once it is cancelled. The token must outlive the parse. A single
+	 * token is lexed without polling.
+	 */
+	void setCancellationToken (const CancellationToken & token) {
+		m_cancellation = &token;
+	}
+
+	// Only called when the parser is built with CYCLONE_PARSER_PROFILING, see RuleProfiler:
+	void setProfiler (RuleProfiler & profiler) {
+		m_profiler = &profiler;
+	}
+
+	// A cancelled parse returns the tree up to there, which isn't complete. The root is
+	// null with a TreeBuilder of its own:
 	SyntaxTree parse ();
 
+	/**
+	 * Parses textBuffer, which is the text of tree with edit applied. Only the innermost
+	 * NAMESPACE or USING node that contains the edit is reparsed, when the new node ends
+	 * where the old one ended (moved by the edit) the rest of the tree is the same as
+	 * before and is shared. Otherwise the enclosing nodes are tried, up to a full parse.
+	 * The result is the same as that of parse (). A tree of parseLazily () is parsed
+	 * lazily again, without sharing, the result is the same as that of parseLazily ().
+	 */
+	static SyntaxTree reparse (const SyntaxTree & tree, const TextBuffer & textBuffer, const TextEdit & edit);
+
+	/**
+	 * Parses textBuffer without the bodies of namespaces, enough for an outline. A body is
+	 * only brace matched, and becomes a LazyNode between the braces of the NAMESPACE node.
+	 * The LazyNode parses it into a NAMESPACE_BODY node on first access, with the bodies of
+	 * nested namespaces lazy again. For valid text, the children of the NAMESPACE_BODY node
+	 * are the nodes parse () has between the braces. Errors in a body are contained in it.
+	 */
+	static SyntaxTree parseLazily (const TextBuffer & textBuffer);
+
 	Result parseCompilationUnit ();
 	Result parseNamespace ();
 	Result parseUsing ();
@@ -69,25 +137,46 @@ public:
 private:
 
 	friend class internal::RuleScope;
+	friend class internal::LazyNamespaceBody;
 	typedef internal::RuleScope RuleScope;
 
 	void parseNamespaceContent ();
-
-	Node * node () const;
-
-	static bool isNonSignificant (TokenType tokenType);
+	Result parseNamespaceBody ();
+	void skipNamespaceBody ();
 
 	bool check (TokenType tokenType);
-	void expect (TokenType tokenType);
+	bool expect (TokenType tokenType);
 	void accept ();
-	Result recover (std::initializer_list<TokenType> validTokenTypes);
-
-	void add (const std::shared_ptr<NodeBase> & n) {
-		node ()->addNode (n);
+	void recover (std::initializer_list<TokenType> validTokenTypes);
+
+	// Add or skip the trivia before index end:
+	void addTrivia (std::size_t end);
+	void skipTrivia (std::size_t end);
+
+	// Of the next significant token:
+	std::size_t nextTokenOffset ();
+
+	// Throws ParseCancelled when the cancellation token is cancelled, looking at it every
+	// cancellationPollInterval calls:
+	void poll () {
+		if (m_cancellation != nullptr && -- m_pollCountdown == 0) {
+			m_pollCountdown = cancellationPollInterval;
+			if (m_cancellation->isCancelled ()) {
+				throw ParseCancelled ();
+			}
+		}
 	}
 
-	Lexer &									m_lexer;
-	std::stack<internal::RuleScope *>		m_scopes;
+	SignificantLexer	m_lexer;
+	std::size_t			m_trivia;		// The next trivia to add to the tree
+	std::size_t			m_offset;		// Of the next trivia, from the start of the lexer
+	const TextBuffer *	m_lazyText;		// The text when namespace bodies are lazy
+	std::size_t			m_lazyTextOffset;	// Of the start of the lexer in m_lazyText
+	const CancellationToken *	m_cancellation;
+	unsigned			m_pollCountdown;
+	RuleProfiler *		m_profiler;
+	NodeBuilder			m_nodeBuilder;
+	TreeBuilder &		m_builder;
 };
 
 }	// namespace parser
@@ -0,0 +1,136 @@
+#include <cyclone/parser/RuleProfiler.h>
+#include <CycloneConfig.h>
+#include <algorithm>
+#include <iomanip>
+
+namespace cyclone {
+namespace parser {
+
+	namespace {
+		// The last node type:
+		const unsigned nodeTypeCount = unsigned (RuleProfiler::NodeType::NAMESPACE_BODY) + 1;
+
+		double milliseconds (RuleProfiler::Duration duration) {
+			return std::chrono::duration<double, std::milli> (duration).count ();
+		}
+
+		double microseconds (RuleProfiler::Duration duration) {
+			return std::chrono::duration<double, std::micro> (duration).count ();
+		}
+	}
+
+#ifdef CYCLONE_PARSER_PROFILING
+	const bool RuleProfiler::enabled = true;
+#else
+	const bool RuleProfiler::enabled = false;
+#endif
+
+	RuleProfiler :: RuleProfiler (bool trace)
+		: m_statistics (nodeTypeCount), m_trace (trace), m_origin (Clock::now ()) {
+		clear ();
+	}
+
+	void RuleProfiler :: enter (NodeType type) {
+		Frame frame = { type, Clock::now (), Duration::zero (), 1 };
+		m_frames.push_back (frame);
+	}
+
+	void RuleProfiler :: leave () {
+		Clock::time_point now = Clock::now ();
+		const Frame & frame = m_frames.back ();
+		Duration time = now - frame.start;
+
+		Statistics & statistics = m_statistics[unsigned (frame.type)];
+		++ statistics.calls;
+		statistics.inclusiveTime += time;
+		statistics.exclusiveTime += time - frame.childTime;
+		statistics.nodes += frame.nodes;
+
+		if (m_trace) {
+			TraceEvent event = { frame.type, frame.start - m_origin, time };
+			m_events.push_back (event);
+		}
+
+		std::uint64_t nodes = frame.nodes;
+		m_frames.pop_back ();
+		if (!m_frames.empty ()) {
+			m_frames.back ().childTime += time;
+			m_frames.back ().nodes += nodes;
+		}
+	}
+
+	void RuleProfiler :: token () {
+		if (!m_frames.empty ()) {
+			++ m_statistics[unsigned (m_frames.back ().type)].tokens;
+			++ m_frames.back ().nodes;
+		}
+	}
+
+	void RuleProfiler :: recovery () {
+		if (!m_frames.empty ()) {
+			++ m_statistics[unsigned (m_frames.back ().type)].recoveries;
+		}
+	}
+
+	void RuleProfiler :: clear () {
+		Statistics empty = { 0, Duration::zero (), Duration::zero (), 0, 0, 0 };
+		std::fill (m_statistics.begin (), m_statistics.end (), empty);
+		m_frames.clear ();
+		m_events.clear ();
+		m_origin = Clock::now ();
+	}
+
+	void RuleProfiler :: writeReport (std::ostream & out) const {
+		std::vector<unsigned> types;
+		for (unsigned i = 0; i < m_statistics.size (); ++ i) {
+			if (m_statistics[i].calls > 0) {
+				types.push_back (i);
+			}
+		}
+		std::stable_sort (types.begin (), types.end (), [this] (unsigned a, unsigned b) {
+			return m_statistics[a].exclusiveTime > m_statistics[b].exclusiveTime;
+		});
+
+		out << "rule\tcalls\tinclusive_ms\texclusive_ms\ttokens\tnodes\trecoveries" << std::endl;
+		for (unsigned i: types) {
+			const Statistics & s = m_statistics[i];
+			out << name (NodeType (i))
+				<< "\t" << s.calls
+				<< std::fixed << std::setprecision (3)
+				<< "\t" << milliseconds (s.inclusiveTime)
+				<< "\t" << milliseconds (s.exclusiveTime)
+				<< "\t" << s.tokens
+				<< "\t" << s.nodes
+				<< "\t" << s.recoveries
+				<< std::endl;
+		}
+	}
+
+	void RuleProfiler :: writeChromeTrace (std::ostream & out) const {
+		out << "{\"traceEvents\":[";
+		for (std::vector<TraceEvent>::const_iterator it = m_events.begin (); it != m_events.end (); ++ it) {
+			out << (it == m_events.begin () ? "\n" : ",\n")
+				<< "{\"name\":\"" << name (it->type) << "\""
+				<< ",\"cat\":\"parser\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+				<< std::fixed << std::setprecision (3)
+				<< ",\"ts\":" << microseconds (it->start)
+				<< ",\"dur\":" << microseconds (it->duration)
+				<< "}";
+		}
+		out << "\n]}" << std::endl;
+	}
+
+	const char * RuleProfiler :: name (NodeType type) {
+		switch (type) {
+		case NodeType::ERROR:				return "ERROR";
+		case NodeType::COMPILATION_UNIT:	return "COMPILATION_UNIT";
+		case NodeType::NAMESPACE:			return "NAMESPACE";
+		case NodeType::USING:				return "USING";
+		case NodeType::SCOPED_NAME:			return "SCOPED_NAME";
+		case NodeType::NAMESPACE_BODY:		return "NAMESPACE_BODY";
+		}
+		return "?";
+	}
+
+}	// namespace parser
+}	// namespace cyclone
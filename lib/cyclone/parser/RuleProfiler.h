@@ -0,0 +1,87 @@
+#ifndef CYCLONE_PARSER_RULEPROFILER_H__
+#define CYCLONE_PARSER_RULEPROFILER_H__
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include <cyclone/syntaxtree/Node.h>
+
+namespace cyclone {
+namespace parser {
+
+/**
+ * Statistics per grammar rule, by the type of the node the rule makes. The parser calls
+ * the profiler set with Parser::setProfiler when a rule starts and ends, and for each
+ * token and error, but only when it is built with the CMake option
+ * CYCLONE_PARSER_PROFILING. Otherwise the calls are compiled out and the statistics stay
+ * empty. Lazy namespace bodies are parsed by a parser of their own, and not profiled. Not
+ * thread safe, use a profiler per parser.
+ */
+class RuleProfiler {
+public:
+
+	typedef cyclone::syntaxtree::NodeType		NodeType;
+	typedef std::chrono::steady_clock			Clock;
+	typedef Clock::duration						Duration;
+
+	// Whether the parser was built to call the profiler:
+	static const bool enabled;
+
+	struct Statistics {
+		std::uint64_t	calls;
+		Duration		inclusiveTime;
+		Duration		exclusiveTime;		// Without the rules that were called from it
+		std::uint64_t	tokens;				// Tokens and trivia added to the node itself
+		std::uint64_t	nodes;				// Nodes and terminals of the tree, the node included
+		std::uint64_t	recoveries;			// Tokens it expected and didn't find
+	};
+
+	// With trace, every rule is also recorded for writeChromeTrace ():
+	explicit RuleProfiler (bool trace = false);
+
+	void enter (NodeType type);
+	void leave ();
+	void token ();
+	void recovery ();
+
+	const Statistics & statistics (NodeType type) const {
+		return m_statistics[unsigned (type)];
+	}
+
+	void clear ();
+
+	// A line per rule that was called, the most exclusive time first:
+	void writeReport (std::ostream & out) const;
+
+	// The traced rules as complete events in the Trace Event Format, for chrome://tracing:
+	void writeChromeTrace (std::ostream & out) const;
+
+	static const char * name (NodeType type);
+
+private:
+
+	struct Frame {
+		NodeType			type;
+		Clock::time_point	start;
+		Duration			childTime;
+		std::uint64_t		nodes;
+	};
+
+	struct TraceEvent {
+		NodeType		type;
+		Duration		start;		// From m_origin
+		Duration		duration;
+	};
+
+	std::vector<Statistics>	m_statistics;	// By node type
+	std::vector<Frame>		m_frames;		// The open rules
+	bool					m_trace;
+	Clock::time_point		m_origin;
+	std::vector<TraceEvent>	m_events;
+};
+
+}	// namespace parser
+}	// namespace cyclone
+
+#endif	// CYCLONE_PARSER_RULEPROFILER_H__
@@ -0,0 +1,85 @@
+#include <cyclone/parser/SignificantLexer.h>
+
+namespace cyclone {
+namespace parser {
+
+	using namespace cyclone::syntaxtree;
+
+	SignificantLexer :: SignificantLexer (const TokenSource & lexer)
+		: m_lexer (lexer),
+		  m_lookahead (Lexer::initialLookahead),
+		  m_trivia (Lexer::initialLookahead),
+		  m_triviaBase (0),
+		  m_triviaEnd (0),
+		  m_acceptedTrivia (0),
+		  m_trailingLineBreak (false) {
+	}
+
+	const SignificantToken & SignificantLexer :: la (unsigned offset) {
+		while (m_lookahead.size () <= offset) {
+			next ();
+		}
+
+		return m_lookahead[offset];
+	}
+
+	SignificantToken SignificantLexer :: accept () {
+		la ();
+
+		// The trivia before the trailing trivia of the previously accepted token isn't
+		// needed anymore:
+		while (m_triviaBase < m_acceptedTrivia) {
+			m_trivia.pop_front ();
+			++ m_triviaBase;
+		}
+
+		SignificantToken token = m_lookahead.pop_front ();
+		m_acceptedTrivia = token.trailingTrivia.begin;
+		return token;
+	}
+
+	void SignificantLexer :: next () {
+		SignificantToken token;
+		bool leadingLineBreak = false;
+		bool trailingLineBreak = false;
+
+		token.leadingTrivia = lexTrivia (false, leadingLineBreak);
+		token.hasLineBreakBefore = m_trailingLineBreak || leadingLineBreak;
+		token.token = m_lexer.accept ();
+
+		if (token.token.type () == TokenType::END_OF_INPUT) {
+			token.trailingTrivia.begin = token.trailingTrivia.end = m_triviaEnd;
+		} else {
+			token.trailingTrivia = lexTrivia (true, trailingLineBreak);
+		}
+
+		m_trailingLineBreak = trailingLineBreak;
+		m_lookahead.push_back (token);
+	}
+
+	TriviaRange SignificantLexer :: lexTrivia (bool trailing, bool & hasLineBreak) {
+		TriviaRange range;
+		range.begin = m_triviaEnd;
+
+		while (isTrivia (m_lexer.la ().type ())) {
+			Token token = m_lexer.accept ();
+			m_trivia.push_back (token);
+			++ m_triviaEnd;
+			range.length += token.length ();
+
+			if (token.hasLineBreak ()) {
+				hasLineBreak = true;
+			}
+
+			// Trailing trivia ends with the line:
+			if (trailing && (token.hasLineBreak () || token.type () == TokenType::SINGLE_LINE_COMMENT)) {
+				break;
+			}
+		}
+
+		range.end = m_triviaEnd;
+		return range;
+	}
+
+}	// namespace parser
+}	// namespace cyclone
@@ -0,0 +1,135 @@
+#ifndef CYCLONE_PARSER_SIGNIFICANTLEXER_H__
+#define CYCLONE_PARSER_SIGNIFICANTLEXER_H__
+
+#include <cyclone/core/RingBuffer.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/syntaxtree/Token.h>
+
+namespace cyclone {
+namespace parser {
+
+/**
+ * A range of trivia tokens (whitespace, comments and invalid characters), as indices into
+ * the trivia of a SignificantLexer. Indices count all trivia since the start of the input.
+ */
+struct TriviaRange {
+	TriviaRange () : begin (0), end (0), length (0) {
+	}
+
+	std::size_t count () const {
+		return end - begin;
+	}
+
+	std::size_t	begin;
+	std::size_t	end;
+	std::size_t	length;		// In characters
+};
+
+/**
+ * A significant token with the trivia around it. Trailing trivia runs up to and including
+ * the first trivia token that ends a line, the rest of the trivia before the next
+ * significant token is its leading trivia.
+ */
+struct SignificantToken {
+	SignificantToken () : hasLineBreakBefore (false) {
+	}
+
+	cyclone::syntaxtree::Token	token;
+	TriviaRange					leadingTrivia;
+	TriviaRange					trailingTrivia;
+
+	// Whether the trivia since the previous significant token has a line break:
+	bool						hasLineBreakBefore;
+};
+
+/**
+ * A lexer of any scanner type, such as a Lexer or a Utf8Lexer, called through function
+ * pointers. The lexer must outlive the source.
+ */
+class TokenSource {
+public:
+
+	typedef cyclone::syntaxtree::Token		Token;
+
+	template<typename ScannerType>
+	TokenSource (BasicLexer<ScannerType> & lexer)
+		: m_lexer (&lexer),
+		  m_la (&la<ScannerType>),
+		  m_accept (&accept<ScannerType>) {
+	}
+
+	Token la () const {
+		return m_la (m_lexer);
+	}
+
+	Token accept () const {
+		return m_accept (m_lexer);
+	}
+
+private:
+
+	template<typename ScannerType>
+	static Token la (void * lexer) {
+		return static_cast<BasicLexer<ScannerType> *> (lexer)->la ();
+	}
+
+	template<typename ScannerType>
+	static Token accept (void * lexer) {
+		return static_cast<BasicLexer<ScannerType> *> (lexer)->accept ();
+	}
+
+	void *	m_lexer;
+	Token	(*m_la) (void * lexer);
+	Token	(*m_accept) (void * lexer);
+};
+
+/**
+ * A view of a lexer that only returns significant tokens. Looking ahead and checking a
+ * token type doesn't depend on the amount of trivia. The trivia stays available through
+ * trivia () from the trailing trivia of the last accepted token on, so that a parser can
+ * still add every token to a lossless tree.
+ */
+class SignificantLexer {
+public:
+
+	typedef cyclone::syntaxtree::Token		Token;
+	typedef cyclone::syntaxtree::TokenType	TokenType;
+
+	explicit SignificantLexer (const TokenSource & lexer);
+
+	const SignificantToken & la (unsigned offset = 0);
+	SignificantToken accept ();
+
+	bool check (TokenType tokenType, unsigned offset = 0) {
+		return la (offset).token.type () == tokenType;
+	}
+
+	const Token & trivia (std::size_t index) const {
+		return m_trivia[index - m_triviaBase];
+	}
+
+	static bool isTrivia (TokenType tokenType) {
+		return tokenType == TokenType::WHITESPACE
+			|| tokenType == TokenType::SINGLE_LINE_COMMENT
+			|| tokenType == TokenType::MULTI_LINE_COMMENT
+			|| tokenType == TokenType::INVALID_CHARACTERS;
+	}
+
+private:
+
+	void next ();
+	TriviaRange lexTrivia (bool trailing, bool & hasLineBreak);
+
+	TokenSource									m_lexer;
+	cyclone::core::RingBuffer<SignificantToken>	m_lookahead;
+	cyclone::core::RingBuffer<Token>			m_trivia;
+	std::size_t									m_triviaBase;
+	std::size_t									m_triviaEnd;
+	std::size_t									m_acceptedTrivia;
+	bool										m_trailingLineBreak;
+};
+
+}	// namespace parser
+}	// namespace cyclone
+
+#endif	// CYCLONE_PARSER_SIGNIFICANTLEXER_H__
@@ -0,0 +1,197 @@
+#include <cyclone/parser/TokenStream.h>
+#include <algorithm>
+
+namespace cyclone {
+namespace parser {
+
+	using namespace cyclone::syntaxtree;
+
+	Token TokenStream::Iterator :: operator * () const {
+		std::size_t position = m_position;
+		std::size_t length = m_stream->decodeLength (position);
+
+		std::uint32_t symbol = m_stream->hasSymbol (m_index) ? m_stream->m_symbols[m_symbolPosition] : 0;
+
+		return Token (m_stream->type (m_index), m_stream->error (m_index), length, m_stream->hasLineBreak (m_index), symbol);
+	}
+
+	TokenStream::Iterator & TokenStream::Iterator :: operator ++ () {
+		m_offset += m_stream->decodeLength (m_position);
+		if (m_stream->hasSymbol (m_index)) {
+			++ m_symbolPosition;
+		}
+		++ m_index;
+		return *this;
+	}
+
+	TokenStream :: TokenStream () : m_size (0), m_textLength (0) {
+	}
+
+	void TokenStream :: push_back (const Token & token) {
+		if (m_size % sampleInterval == 0) {
+			Sample sample;
+			sample.offset = m_textLength;
+			sample.position = m_lengths.size ();
+			sample.symbolPosition = m_symbols.size ();
+			m_samples.push_back (sample);
+		}
+
+		if (m_size % 64 == 0) {
+			m_lineBreaks.push_back (0);
+			m_hasSymbol.push_back (0);
+		}
+
+		m_types.push_back (std::uint8_t (token.type ()));
+
+		// LEB128, seven bits per byte, the high bit marks that more bytes follow:
+		std::size_t length = token.length ();
+		while (length >= 0x80) {
+			m_lengths.push_back (std::uint8_t (length | 0x80));
+			length >>= 7;
+		}
+		m_lengths.push_back (std::uint8_t (length));
+
+		if (token.hasLineBreak ()) {
+			m_lineBreaks.back () |= std::uint64_t (1) << (m_size % 64);
+		}
+
+		if (token.symbol () != 0) {
+			m_hasSymbol.back () |= std::uint64_t (1) << (m_size % 64);
+			m_symbols.push_back (token.symbol ());
+		}
+
+		if (token.error () != TokenError::NO_ERROR) {
+			ErrorEntry entry;
+			entry.index = m_size;
+			entry.error = token.error ();
+			m_errors.push_back (entry);
+		}
+
+		m_textLength += token.length ();
+		++ m_size;
+	}
+
+	void TokenStream :: clear () {
+		m_types.clear ();
+		m_lengths.clear ();
+		m_lineBreaks.clear ();
+		m_hasSymbol.clear ();
+		m_symbols.clear ();
+		m_errors.clear ();
+		m_samples.clear ();
+		m_size = 0;
+		m_textLength = 0;
+	}
+
+	void TokenStream :: shrink_to_fit () {
+		m_types.shrink_to_fit ();
+		m_lengths.shrink_to_fit ();
+		m_lineBreaks.shrink_to_fit ();
+		m_hasSymbol.shrink_to_fit ();
+		m_symbols.shrink_to_fit ();
+		m_errors.shrink_to_fit ();
+		m_samples.shrink_to_fit ();
+	}
+
+	std::size_t TokenStream :: decodeLength (std::size_t & position) const {
+		std::size_t length = 0;
+		unsigned shift = 0;
+		std::uint8_t byte;
+
+		do {
+			byte = m_lengths[position ++];
+			length |= std::size_t (byte & 0x7f) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+
+		return length;
+	}
+
+	Token TokenStream :: operator [] (std::size_t index) const {
+		return *at (index);
+	}
+
+	std::size_t TokenStream :: length (std::size_t index) const {
+		std::size_t position = m_samples[index / sampleInterval].position;
+
+		// Skip the lengths before index, only the last byte of a varint has the high bit clear:
+		for (std::size_t skip = index % sampleInterval; skip > 0; ++ position) {
+			if ((m_lengths[position] & 0x80) == 0) {
+				-- skip;
+			}
+		}
+
+		return decodeLength (position);
+	}
+
+	std::size_t TokenStream :: offset (std::size_t index) const {
+		if (index == m_size) {
+			return m_textLength;
+		}
+		return at (index).offset ();
+	}
+
+	TokenStream::TokenError TokenStream :: error (std::size_t index) const {
+		std::vector<ErrorEntry>::const_iterator it = std::lower_bound (m_errors.begin (), m_errors.end (), index,
+			[] (const ErrorEntry & entry, std::size_t index) { return entry.index < index; });
+
+		return it != m_errors.end () && it->index == index ? it->error : TokenError::NO_ERROR;
+	}
+
+	std::size_t TokenStream :: indexAt (std::size_t offset) const {
+		if (offset >= m_textLength) {
+			return m_size;
+		}
+
+		// The last sample at or before offset:
+		std::vector<Sample>::const_iterator sample = std::upper_bound (m_samples.begin (), m_samples.end (), offset,
+			[] (std::size_t offset, const Sample & sample) { return offset < sample.offset; }) - 1;
+
+		std::size_t index = (sample - m_samples.begin ()) * sampleInterval;
+		std::size_t position = sample->position;
+		std::size_t end = sample->offset + decodeLength (position);
+
+		while (end <= offset) {
+			end += decodeLength (position);
+			++ index;
+		}
+
+		return index;
+	}
+
+	TokenStream::Iterator TokenStream :: begin () const {
+		return Iterator (this, 0, 0, 0, 0);
+	}
+
+	TokenStream::Iterator TokenStream :: end () const {
+		return Iterator (this, m_size, m_lengths.size (), m_symbols.size (), m_textLength);
+	}
+
+	TokenStream::Iterator TokenStream :: at (std::size_t index) const {
+		if (index >= m_size) {
+			return end ();
+		}
+
+		const Sample & sample = m_samples[index / sampleInterval];
+		Iterator it (this, index - index % sampleInterval, sample.position, sample.symbolPosition, sample.offset);
+
+		while (it.m_index < index) {
+			++ it;
+		}
+
+		return it;
+	}
+
+	std::size_t TokenStream :: memoryUsage () const {
+		return sizeof (*this)
+			+ m_types.capacity () * sizeof (std::uint8_t)
+			+ m_lengths.capacity () * sizeof (std::uint8_t)
+			+ m_lineBreaks.capacity () * sizeof (std::uint64_t)
+			+ m_hasSymbol.capacity () * sizeof (std::uint64_t)
+			+ m_symbols.capacity () * sizeof (std::uint32_t)
+			+ m_errors.capacity () * sizeof (ErrorEntry)
+			+ m_samples.capacity () * sizeof (Sample);
+	}
+
+}	// namespace parser
+}	// namespace cyclone
@@ -0,0 +1,159 @@
+#ifndef CYCLONE_PARSER_TOKENSTREAM_H__
+#define CYCLONE_PARSER_TOKENSTREAM_H__
+
+#include <cstdint>
+#include <vector>
+#include <cyclone/syntaxtree/Token.h>
+
+namespace cyclone {
+namespace parser {
+
+/**
+ * A compact, append-only list of tokens, stored as separate arrays: one byte of token type
+ * per token, the lengths as LEB128 varints (one byte for tokens shorter than 128
+ * characters, more bytes for longer ones), the line break flags as a bit set, and the
+ * errors, which are rare, as a sorted list. Symbols of interned names are stored densely
+ * for the tokens that have one, marked in a second bit set. Every sampleInterval tokens a
+ * sample records the offset of the token and the positions of its length and symbol, so
+ * that random access and offsets decode at most sampleInterval lengths. Typical source
+ * needs less than three bytes per token, instead of sizeof (Token).
+ */
+class TokenStream {
+public:
+
+	typedef cyclone::syntaxtree::Token		Token;
+	typedef cyclone::syntaxtree::TokenType	TokenType;
+	typedef cyclone::syntaxtree::TokenError	TokenError;
+
+	static const std::size_t sampleInterval = 64;
+
+	class Iterator {
+	public:
+
+		Iterator () : m_stream (0), m_index (0), m_position (0), m_symbolPosition (0), m_offset (0) {
+		}
+
+		Token operator * () const;
+
+		Iterator & operator ++ ();
+
+		Iterator operator ++ (int) {
+			Iterator copy (*this);
+			++ (*this);
+			return copy;
+		}
+
+		bool operator == (const Iterator & other) const {
+			return m_stream == other.m_stream && m_index == other.m_index;
+		}
+
+		bool operator != (const Iterator & other) const {
+			return !((*this) == other);
+		}
+
+		std::size_t index () const {
+			return m_index;
+		}
+
+		// Offset of the token in the text:
+		std::size_t offset () const {
+			return m_offset;
+		}
+
+	private:
+
+		friend class TokenStream;
+
+		Iterator (const TokenStream * stream, std::size_t index, std::size_t position, std::size_t symbolPosition, std::size_t offset)
+			: m_stream (stream), m_index (index), m_position (position), m_symbolPosition (symbolPosition), m_offset (offset) {
+		}
+
+		const TokenStream *	m_stream;
+		std::size_t			m_index;
+		std::size_t			m_position;
+		std::size_t			m_symbolPosition;
+		std::size_t			m_offset;
+	};
+
+	TokenStream ();
+
+	void push_back (const Token & token);
+	void clear ();
+	void shrink_to_fit ();
+
+	std::size_t size () const {
+		return m_size;
+	}
+
+	bool empty () const {
+		return m_size == 0;
+	}
+
+	// The number of characters covered by all tokens:
+	std::size_t textLength () const {
+		return m_textLength;
+	}
+
+	Token operator [] (std::size_t index) const;
+
+	TokenType type (std::size_t index) const {
+		return TokenType (m_types[index]);
+	}
+
+	std::size_t length (std::size_t index) const;
+	std::size_t offset (std::size_t index) const;
+
+	bool hasLineBreak (std::size_t index) const {
+		return (m_lineBreaks[index / 64] >> (index % 64)) & 1;
+	}
+
+	TokenError error (std::size_t index) const;
+
+	std::uint32_t symbol (std::size_t index) const {
+		return (*at (index)).symbol ();
+	}
+
+	// Returns the index of the token that contains offset, or size () past the last token:
+	std::size_t indexAt (std::size_t offset) const;
+
+	Iterator begin () const;
+	Iterator end () const;
+	Iterator at (std::size_t index) const;
+
+	// Bytes allocated by the stream:
+	std::size_t memoryUsage () const;
+
+private:
+
+	struct Sample {
+		std::size_t	offset;
+		std::size_t	position;
+		std::size_t	symbolPosition;
+	};
+
+	struct ErrorEntry {
+		std::size_t	index;
+		TokenError	error;
+	};
+
+	std::size_t decodeLength (std::size_t & position) const;
+
+	bool hasSymbol (std::size_t index) const {
+		return (m_hasSymbol[index / 64] >> (index % 64)) & 1;
+	}
+
+	std::vector<std::uint8_t>	m_types;
+	std::vector<std::uint8_t>	m_lengths;
+	std::vector<std::uint64_t>	m_lineBreaks;
+	std::vector<std::uint64_t>	m_hasSymbol;
+	std::vector<std::uint32_t>	m_symbols;
+	std::vector<ErrorEntry>		m_errors;
+	std::vector<Sample>			m_samples;
+	std::size_t					m_size;
+	std::size_t					m_textLength;
+};
+
+}	// namespace parser
+}	// namespace cyclone
+
+#endif	// CYCLONE_PARSER_TOKENSTREAM_H__
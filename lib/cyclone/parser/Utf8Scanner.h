@@ -0,0 +1,185 @@
+#ifndef CYCLONE_PARSER_UTF8SCANNER_H__
+#define CYCLONE_PARSER_UTF8SCANNER_H__
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cyclone/core/RingBuffer.h>
+
+namespace cyclone {
+namespace parser {
+
+namespace internal {
+	/**
+	 * Reads UTF-8 text from memory as UTF-16 code units, the scanner interface of the
+	 * lexer. Code points outside the BMP are read as surrogate pairs, invalid bytes as
+	 * U+FFFD. ASCII, which is all the lexer looks at outside of strings and comments, is
+	 * read directly from the bytes.
+	 */
+	class Utf8Scanner {
+	public:
+
+		enum class LengthUnit {
+			UTF8,		// Bytes
+			UTF16,		// Code units, the same lengths as the TextBuffer lexer
+			CODE_POINTS
+		};
+
+		// The lexer measures tokens with position () instead of counting characters:
+		static const bool charactersAreLengthUnits = false;
+
+		static const unsigned maxLookahead = 8;
+
+		Utf8Scanner (const char * begin, const char * end, LengthUnit lengthUnit)
+			: m_current (reinterpret_cast<const unsigned char *> (begin)),
+			  m_end (reinterpret_cast<const unsigned char *> (end)),
+			  m_lengthUnit (lengthUnit),
+			  m_position (0),
+			  m_lookahead (maxLookahead) {
+		}
+
+		char16_t la (unsigned offset = 0) {
+			// The ring never has to grow:
+			assert (offset < maxLookahead);
+
+			if (m_lookahead.size () <= offset) {
+				fill (offset);
+			}
+
+			return m_lookahead[offset].character;
+		}
+
+		char16_t accept () {
+			la ();
+
+			Unit unit = m_lookahead.pop_front ();
+			m_position += unit.width;
+			return unit.character;
+		}
+
+		bool check (char16_t ch, unsigned offset = 0) {
+			return la (offset) == ch;
+		}
+
+		// See Scanner::acceptWhile:
+		template<typename Predicate>
+		std::size_t acceptWhile (Predicate predicate) {
+			std::size_t count = 0;
+
+			while (true) {
+				while (!m_lookahead.empty ()) {
+					if (!predicate (m_lookahead.front ().character)) {
+						return count;
+					}
+					m_position += m_lookahead.pop_front ().width;
+					++ count;
+				}
+
+				const unsigned char * p = m_current;
+				while (p != m_end && *p < 0x80 && predicate (char16_t (*p))) {
+					++ p;
+				}
+
+				count += p - m_current;
+				m_position += p - m_current;
+				m_current = p;
+
+				if (p == m_end || *p < 0x80) {
+					return count;
+				}
+
+				decode ();
+			}
+		}
+
+		bool isRangeComplete () const {
+			return m_current == m_end && (m_lookahead.empty () || m_lookahead.front ().character == 0);
+		}
+
+		// The number of accepted length units:
+		std::size_t position () const {
+			return m_position;
+		}
+
+	private:
+
+		struct Unit {
+			char16_t		character;
+			std::uint8_t	width;		// In length units, the second half of a surrogate pair has none
+		};
+
+		void push (char16_t character, unsigned width) {
+			Unit unit;
+			unit.character = character;
+			unit.width = std::uint8_t (width);
+			m_lookahead.push_back (unit);
+		}
+
+		void fill (unsigned offset) {
+			while (m_lookahead.size () <= offset) {
+				decode ();
+			}
+		}
+
+		// Reads the next code point into the lookahead:
+		void decode () {
+			if (m_current == m_end) {
+				push (0, 0);
+				return;
+			}
+
+			unsigned char lead = *m_current;
+			if (lead < 0x80) {
+				push (lead, 1);
+				++ m_current;
+				return;
+			}
+
+			std::size_t length = lead >= 0xc2 && lead <= 0xdf ? 2
+				: lead >= 0xe0 && lead <= 0xef ? 3
+				: lead >= 0xf0 && lead <= 0xf4 ? 4
+				: 0;
+			std::uint32_t codePoint = lead & (0x7f >> length);
+
+			bool valid = length > 0 && std::size_t (m_end - m_current) >= length;
+			for (std::size_t i = 1; valid && i < length; ++ i) {
+				valid = (m_current[i] & 0xc0) == 0x80;
+				codePoint = (codePoint << 6) | (m_current[i] & 0x3f);
+			}
+
+			// Overlong encodings, surrogates and code points beyond U+10FFFF:
+			valid = valid && !(length == 3 && (codePoint < 0x800 || (codePoint >= 0xd800 && codePoint <= 0xdfff)))
+				&& !(length == 4 && (codePoint < 0x10000 || codePoint > 0x10ffff));
+
+			if (!valid) {
+				push (0xfffd, 1);
+				++ m_current;
+				return;
+			}
+
+			m_current += length;
+
+			unsigned width = m_lengthUnit == LengthUnit::UTF8 ? unsigned (length)
+				: m_lengthUnit == LengthUnit::UTF16 && codePoint >= 0x10000 ? 2
+				: 1;
+
+			if (codePoint < 0x10000) {
+				push (char16_t (codePoint), width);
+			} else {
+				push (char16_t (0xd800 + ((codePoint - 0x10000) >> 10)), width);
+				push (char16_t (0xdc00 + (codePoint & 0x3ff)), 0);
+			}
+		}
+
+		const unsigned char *			m_current;
+		const unsigned char *			m_end;
+		LengthUnit						m_lengthUnit;
+		std::size_t						m_position;
+		cyclone::core::RingBuffer<Unit>	m_lookahead;
+	};
+}
+
+}	// namespace parser
+}	// namespace cyclone
+
+#endif	// CYCLONE_PARSER_UTF8SCANNER_H__
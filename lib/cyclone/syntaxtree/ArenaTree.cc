@@ -0,0 +1,120 @@
+#include <cyclone/syntaxtree/ArenaTree.h>
+#include <stdexcept>
+
+namespace cyclone {
+namespace syntaxtree {
+
+	void ArenaTreeBuilder :: startNode (NodeType type) {
+		Event event = { 0, 0, std::uint8_t (type), 0, false, EventType::START };
+		m_events.push_back (event);
+	}
+
+	void ArenaTreeBuilder :: token (const Token & token, std::size_t) {
+		Event event = {
+			token.length (), token.symbol (), std::uint8_t (token.type ()), std::uint8_t (token.error ()), token.hasLineBreak (), EventType::TOKEN
+		};
+		m_events.push_back (event);
+	}
+
+	void ArenaTreeBuilder :: finishNode () {
+		Event event = { 0, 0, 0, 0, false, EventType::FINISH };
+		m_events.push_back (event);
+	}
+
+	ArenaTree ArenaTreeBuilder :: build () {
+		// Count the children of each node, in the order the nodes start:
+		std::vector<std::uint32_t> counts;
+		std::vector<std::size_t> open;
+		std::size_t size = 0;
+
+		for (std::deque<Event>::const_iterator it = m_events.begin (); it != m_events.end (); ++ it) {
+			if (it->type == EventType::FINISH) {
+				if (open.empty ()) {
+					throw std::logic_error ("Finished a node that wasn't started");
+				}
+				open.pop_back ();
+				continue;
+			}
+
+			if (open.empty () && size != 0) {
+				throw std::logic_error ("More than one root");
+			}
+			if (open.empty () && it->type == EventType::TOKEN) {
+				throw std::logic_error ("A token outside of a node");
+			}
+			if (!open.empty ()) {
+				++ counts[open.back ()];
+			}
+			if (it->type == EventType::START) {
+				open.push_back (counts.size ());
+				counts.push_back (0);
+			}
+			++ size;
+		}
+
+		if (!open.empty ()) {
+			throw std::logic_error ("A node wasn't finished");
+		}
+
+		// The root comes first, each node reserves the block for its children when it
+		// starts, and its length is known when it finishes:
+		struct Open {
+			ArenaTree::Node *	node;
+			std::size_t			next;	// Slot of the next child
+		};
+
+		ArenaTree tree;
+		tree.m_nodes.resize (size);
+		ArenaTree::Node * nodes = tree.m_nodes.data ();
+		std::vector<Open> parents;
+		std::size_t next = 1;
+		std::size_t start = 0;
+
+		for (std::deque<Event>::const_iterator it = m_events.begin (); it != m_events.end (); ++ it) {
+			if (it->type == EventType::FINISH) {
+				ArenaTree::Node & node = *parents.back ().node;
+				node.m_length = 0;
+				for (std::uint32_t i = 0; i < node.m_nodeCount; ++ i) {
+					node.m_length += node.m_nodes[i].m_length;
+				}
+				parents.pop_back ();
+				continue;
+			}
+
+			ArenaTree::Node & node = parents.empty () ? nodes[0] : nodes[parents.back ().next ++];
+
+			if (it->type == EventType::START) {
+				node.m_length = 0;
+				node.m_nodes = nodes + next;
+				node.m_nodeCount = counts[start ++];
+				node.m_symbol = 0;
+				node.m_type = NodeType (it->tokenType);
+				node.m_tokenType = 0;
+				node.m_tokenError = 0;
+				node.m_hasLineBreak = false;
+				node.m_isTerminal = false;
+
+				Open parent;
+				parent.node = &node;
+				parent.next = next;
+				parents.push_back (parent);
+				next += node.m_nodeCount;
+			} else {
+				node.m_length = it->length;
+				node.m_nodes = nullptr;
+				node.m_nodeCount = 0;
+				node.m_symbol = it->symbol;
+				node.m_type = NodeType::ERROR;
+				node.m_tokenType = it->tokenType;
+				node.m_tokenError = it->tokenError;
+				node.m_hasLineBreak = it->hasLineBreak;
+				node.m_isTerminal = true;
+			}
+		}
+
+		m_events.clear ();
+		return tree;
+	}
+
+}	// namespace syntaxtree
+}	// namespace cyclone
@@ -0,0 +1,147 @@
+#ifndef CYCLONE_SYNTAXTREE_ARENATREE_H__
+#define CYCLONE_SYNTAXTREE_ARENATREE_H__
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <cyclone/syntaxtree/Node.h>
+#include <cyclone/syntaxtree/Token.h>
+#include <cyclone/syntaxtree/TreeBuilder.h>
+
+namespace cyclone {
+namespace syntaxtree {
+
+/**
+ * A syntax tree in a single array: the children of every node are stored next to each
+ * other, the root first. Building it takes one allocation of the exact size and freeing
+ * it takes one deallocation, instead of two allocations per node and token. The tree
+ * can be moved but not copied, nodes refer to their children by address.
+ */
+class ArenaTree {
+public:
+
+	class Node {
+	public:
+
+		bool isTerminal () const {
+			return m_isTerminal;
+		}
+
+		// The type of a node, ERROR for terminals:
+		NodeType type () const {
+			return m_type;
+		}
+
+		// The token of a terminal:
+		Token token () const {
+			return Token (TokenType (m_tokenType), TokenError (m_tokenError), m_length, m_hasLineBreak, m_symbol);
+		}
+
+		std::size_t length () const {
+			return m_length;
+		}
+
+		std::size_t nodeCount () const {
+			return m_nodeCount;
+		}
+
+		const Node & node (std::size_t i) const {
+			return m_nodes[i];
+		}
+
+	private:
+
+		friend class ArenaTreeBuilder;
+
+		std::size_t		m_length;
+		const Node *	m_nodes;
+		std::uint32_t	m_nodeCount;
+		std::uint32_t	m_symbol;
+		NodeType		m_type;
+		std::uint8_t	m_tokenType;
+		std::uint8_t	m_tokenError;
+		bool			m_hasLineBreak;
+		bool			m_isTerminal;
+	};
+
+	ArenaTree () {
+	}
+
+	ArenaTree (ArenaTree && other) : m_nodes (std::move (other.m_nodes)) {
+	}
+
+	ArenaTree & operator = (ArenaTree && other) {
+		m_nodes = std::move (other.m_nodes);
+		return *this;
+	}
+
+	ArenaTree (const ArenaTree &) = delete;
+	ArenaTree & operator = (const ArenaTree &) = delete;
+
+	bool empty () const {
+		return m_nodes.empty ();
+	}
+
+	const Node & root () const {
+		return m_nodes.front ();
+	}
+
+	// The number of nodes and terminals:
+	std::size_t size () const {
+		return m_nodes.size ();
+	}
+
+	std::size_t memoryUsage () const {
+		return m_nodes.capacity () * sizeof (Node);
+	}
+
+private:
+
+	friend class ArenaTreeBuilder;
+
+	std::vector<Node>	m_nodes;
+};
+
+/**
+ * Records the events of the parser in a flat buffer, and materialises them into an
+ * ArenaTree once the tree is complete.
+ */
+class ArenaTreeBuilder : public TreeBuilder {
+public:
+
+	virtual void startNode (NodeType type);
+	virtual void token (const Token & token, std::size_t offset);
+	virtual void finishNode ();
+
+	/**
+	 * Builds the tree from the events since the last build, which must be a single
+	 * complete tree, and clears them. Throws std::logic_error otherwise.
+	 */
+	ArenaTree build ();
+
+private:
+
+	enum class EventType : std::uint8_t {
+		START,
+		TOKEN,
+		FINISH
+	};
+
+	// A token, or the type of a node in tokenType:
+	struct Event {
+		std::size_t		length;
+		std::uint32_t	symbol;
+		std::uint8_t	tokenType;
+		std::uint8_t	tokenError;
+		bool			hasLineBreak;
+		EventType		type;
+	};
+
+	// Grows in blocks, without copying the events or reserving twice their size:
+	std::deque<Event>	m_events;
+};
+
+}	// namespace syntaxtree
+}	// namespace cyclone
+
+#endif	// CYCLONE_SYNTAXTREE_ARENATREE_H__
@@ -0,0 +1,41 @@
+#include <cyclone/syntaxtree/FlatTree.h>
+
+namespace cyclone {
+namespace syntaxtree {
+
+	FlatTree :: FlatTree (const std::shared_ptr<NodeBase> & root) {
+		add (*root);
+	}
+
+	void FlatTree :: add (const NodeBase & node) {
+		if (node.isLazy ()) {
+			add (*static_cast<const LazyNode &> (node).node ());
+			return;
+		}
+
+		std::size_t index = m_entries.size ();
+
+		Entry entry;
+		entry.length = node.length ();
+		entry.subtreeSize = 1;
+		entry.firstToken = m_tokens.size ();
+		entry.type = NodeType::ERROR;
+		entry.isTerminal = node.isTerminal ();
+		m_entries.push_back (entry);
+
+		if (node.isTerminal ()) {
+			m_tokens.push_back (static_cast<const Terminal &> (node).token ());
+			return;
+		}
+
+		const Node & n = static_cast<const Node &> (node);
+		m_entries[index].type = n.type ();
+
+		for (unsigned i = 0; i < n.nodeCount (); ++ i) {
+			add (*n.node (i));
+		}
+		m_entries[index].subtreeSize = m_entries.size () - index;
+	}
+
+}	// namespace syntaxtree
+}	// namespace cyclone
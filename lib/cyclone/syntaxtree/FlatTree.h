@@ -0,0 +1,111 @@
+#ifndef CYCLONE_SYNTAXTREE_FLATTREE_H__
+#define CYCLONE_SYNTAXTREE_FLATTREE_H__
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <cyclone/syntaxtree/Node.h>
+#include <cyclone/syntaxtree/Token.h>
+
+namespace cyclone {
+namespace syntaxtree {
+
+/**
+ * A read-only copy of a syntax tree with its nodes in pre-order in one array, and its
+ * tokens in another. The subtree of the entry at i is the entries [i, i + subtreeSize),
+ * a walk over the tree is a scan of the array and skipping a subtree is one jump.
+ */
+class FlatTree {
+public:
+
+	struct Entry {
+		std::size_t		length;
+		std::uint32_t	subtreeSize;	// The number of entries, including this one
+		std::uint32_t	firstToken;		// Index of the first token of the subtree, the token of a terminal
+		NodeType		type;			// ERROR for terminals
+		bool			isTerminal;
+	};
+
+	FlatTree () {
+	}
+
+	// Lazy nodes are parsed, and copied as their nodes:
+	explicit FlatTree (const std::shared_ptr<NodeBase> & root);
+
+	std::size_t size () const {
+		return m_entries.size ();
+	}
+
+	const Entry & entry (std::size_t i) const {
+		return m_entries[i];
+	}
+
+	// The index after the subtree at i:
+	std::size_t skip (std::size_t i) const {
+		return i + m_entries[i].subtreeSize;
+	}
+
+	std::size_t tokenCount () const {
+		return m_tokens.size ();
+	}
+
+	const Token & token (std::size_t i) const {
+		return m_tokens[i];
+	}
+
+	/**
+	 * Walks the tree in pre-order, calling on the visitor:
+	 *
+	 *	bool enter (const FlatTree & tree, std::size_t index, std::size_t offset);
+	 *	void leave (const FlatTree & tree, std::size_t index);
+	 *	void token (const Token & token, std::size_t offset);
+	 *
+	 * The children of a node are skipped when enter returns false, leave is only called
+	 * for the nodes entered.
+	 */
+	template<typename Visitor>
+	void walk (Visitor & visitor) const {
+		std::vector<std::size_t> open;	// The entered nodes
+		std::size_t offset = 0;
+
+		for (std::size_t i = 0; i < m_entries.size (); ) {
+			while (!open.empty () && skip (open.back ()) == i) {
+				visitor.leave (*this, open.back ());
+				open.pop_back ();
+			}
+
+			const Entry & entry = m_entries[i];
+			if (entry.isTerminal) {
+				visitor.token (m_tokens[entry.firstToken], offset);
+				offset += entry.length;
+				++ i;
+			} else if (visitor.enter (*this, i, offset)) {
+				open.push_back (i);
+				++ i;
+			} else {
+				offset += entry.length;
+				i = skip (i);
+			}
+		}
+
+		for (; !open.empty (); open.pop_back ()) {
+			visitor.leave (*this, open.back ());
+		}
+	}
+
+	std::size_t memoryUsage () const {
+		return m_entries.capacity () * sizeof (Entry) + m_tokens.capacity () * sizeof (Token);
+	}
+
+private:
+
+	void add (const NodeBase & node);
+
+	std::vector<Entry>	m_entries;
+	std::vector<Token>	m_tokens;
+};
+
+}	// namespace syntaxtree
+}	// namespace cyclone
+
+#endif	// CYCLONE_SYNTAXTREE_FLATTREE_H__
@@ -0,0 +1,228 @@
+#include <cyclone/syntaxtree/GreenNode.h>
+#include <algorithm>
+#include <functional>
+
+namespace cyclone {
+namespace syntaxtree {
+
+	namespace {
+		std::size_t combine (std::size_t hash, std::size_t value) {
+			return hash ^ (value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2));
+		}
+	}
+
+	GreenNode :: GreenNode (const Token & token)
+		: m_token (token),
+		  m_type (NodeType::ERROR),
+		  m_isTerminal (true),
+		  m_length (token.length ()),
+		  m_hash (hash (token)) {
+	}
+
+	GreenNode :: GreenNode (NodeType type, std::vector<Ptr> && nodes)
+		: m_type (type),
+		  m_isTerminal (false),
+		  m_length (0),
+		  m_hash (hash (type, nodes)) {
+		m_nodes.reserve (nodes.size ());
+		for (Ptr & node: nodes) {
+			Child child = { std::move (node), m_length };
+			m_length += child.node->length ();
+			m_nodes.push_back (std::move (child));
+		}
+	}
+
+	std::size_t GreenNode :: indexAt (std::size_t offset) const {
+		if (offset >= m_length) {
+			return m_nodes.size ();
+		}
+
+		// The last child that starts at or before offset, an empty child starts with the next:
+		std::size_t begin = 0;
+		std::size_t end = m_nodes.size ();
+		while (end - begin > 1) {
+			std::size_t middle = begin + (end - begin) / 2;
+			if (m_nodes[middle].offset <= offset) {
+				begin = middle;
+			} else {
+				end = middle;
+			}
+		}
+		return begin;
+	}
+
+	std::size_t GreenNode :: hash (const Token & token) {
+		std::size_t hash = combine (std::size_t (token.type ()), std::size_t (token.error ()));
+		hash = combine (hash, token.length ());
+		hash = combine (hash, token.hasLineBreak ());
+		return combine (hash, token.symbol ());
+	}
+
+	std::size_t GreenNode :: hash (NodeType type, const std::vector<Ptr> & nodes) {
+		std::size_t hash = combine (0x100, std::size_t (type));
+		for (const Ptr & node: nodes) {
+			hash = combine (hash, std::hash<const GreenNode *> () (node.get ()));
+		}
+		return hash;
+	}
+
+	bool GreenNode :: equals (const Token & token) const {
+		return m_isTerminal
+			&& m_token.type () == token.type ()
+			&& m_token.error () == token.error ()
+			&& m_token.length () == token.length ()
+			&& m_token.hasLineBreak () == token.hasLineBreak ()
+			&& m_token.symbol () == token.symbol ();
+	}
+
+	bool GreenNode :: equals (NodeType type, const std::vector<Ptr> & nodes) const {
+		if (m_isTerminal || m_type != type || m_nodes.size () != nodes.size ()) {
+			return false;
+		}
+
+		for (std::size_t i = 0; i < nodes.size (); ++ i) {
+			if (m_nodes[i].node != nodes[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const std::size_t GreenNodeCache::minimumSweepSize = 1024;
+
+	GreenNodeCache :: GreenNodeCache ()
+		: m_sweepSize (minimumSweepSize) {
+	}
+
+	GreenNode::Ptr GreenNodeCache :: terminal (const Token & token) {
+		std::size_t hash = GreenNode::hash (token);
+
+		// Released nodes met on the way are removed:
+		std::pair<Map::iterator, Map::iterator> range = m_nodes.equal_range (hash);
+		for (Map::iterator i = range.first; i != range.second; ) {
+			GreenNode::Ptr node = i->second.lock ();
+			if (!node) {
+				i = m_nodes.erase (i);
+			} else if (node->equals (token)) {
+				return node;
+			} else {
+				++ i;
+			}
+		}
+
+		GreenNode::Ptr node = std::make_shared<GreenNode> (token);
+		insert (hash, node);
+		return node;
+	}
+
+	GreenNode::Ptr GreenNodeCache :: node (NodeType type, std::vector<GreenNode::Ptr> && nodes) {
+		std::size_t hash = GreenNode::hash (type, nodes);
+
+		std::pair<Map::iterator, Map::iterator> range = m_nodes.equal_range (hash);
+		for (Map::iterator i = range.first; i != range.second; ) {
+			GreenNode::Ptr node = i->second.lock ();
+			if (!node) {
+				i = m_nodes.erase (i);
+			} else if (node->equals (type, nodes)) {
+				return node;
+			} else {
+				++ i;
+			}
+		}
+
+		GreenNode::Ptr node = std::make_shared<GreenNode> (type, std::move (nodes));
+		insert (hash, node);
+		return node;
+	}
+
+	std::size_t GreenNodeCache :: size () const {
+		std::size_t size = 0;
+		for (Map::const_iterator i = m_nodes.begin (); i != m_nodes.end (); ++ i) {
+			if (!i->second.expired ()) {
+				++ size;
+			}
+		}
+		return size;
+	}
+
+	void GreenNodeCache :: clear () {
+		m_nodes.clear ();
+		m_converted.clear ();
+		m_sweepSize = minimumSweepSize;
+	}
+
+	void GreenNodeCache :: insert (std::size_t hash, const GreenNode::Ptr & node) {
+		m_nodes.insert (std::make_pair (hash, std::weak_ptr<const GreenNode> (node)));
+		sweepIfFull ();
+	}
+
+	void GreenNodeCache :: sweep () {
+		for (ConvertedMap::iterator i = m_converted.begin (); i != m_converted.end (); ) {
+			if (i->second.node.expired () || i->second.green.expired ()) {
+				i = m_converted.erase (i);
+			} else {
+				++ i;
+			}
+		}
+
+		for (Map::iterator i = m_nodes.begin (); i != m_nodes.end (); ) {
+			if (i->second.expired ()) {
+				i = m_nodes.erase (i);
+			} else {
+				++ i;
+			}
+		}
+
+		// Twice the live entries, so that the cost of a sweep is spread over as many insertions:
+		m_sweepSize = std::max (minimumSweepSize, 2 * (m_nodes.size () + m_converted.size ()));
+	}
+
+	void GreenNodeCache :: sweepIfFull () {
+		if (m_nodes.size () + m_converted.size () >= m_sweepSize) {
+			sweep ();
+		}
+	}
+
+	GreenNode::Ptr GreenNodeCache :: convert (const std::shared_ptr<NodeBase> & node) {
+		if (node->isTerminal ()) {
+			return terminal (std::static_pointer_cast<Terminal> (node)->token ());
+		}
+		if (node->isLazy ()) {
+			return convert (std::static_pointer_cast<LazyNode> (node)->node ());
+		}
+
+		// Declarations are what a reparse shares. A node that is still alive is the one that
+		// was converted, not a new one at the same address:
+		std::shared_ptr<Node> n = std::static_pointer_cast<Node> (node);
+		bool isDeclaration = n->type () == NodeType::NAMESPACE || n->type () == NodeType::USING;
+		if (isDeclaration) {
+			ConvertedMap::iterator i = m_converted.find (node.get ());
+			if (i != m_converted.end ()) {
+				GreenNode::Ptr green = i->second.green.lock ();
+				if (green && i->second.node.lock () == node) {
+					return green;
+				}
+
+				// Released since, or the conversion of a released node at the same address:
+				m_converted.erase (i);
+			}
+		}
+
+		std::vector<GreenNode::Ptr> nodes;
+		nodes.reserve (n->nodeCount ());
+		for (unsigned i = 0; i < n->nodeCount (); ++ i) {
+			nodes.push_back (convert (n->node (i)));
+		}
+
+		GreenNode::Ptr green = this->node (n->type (), std::move (nodes));
+		if (isDeclaration) {
+			Converted & converted = m_converted[node.get ()];
+			converted.node = node;
+			converted.green = green;
+			sweepIfFull ();
+		}
+		return green;
+	}
+
+}	// namespace syntaxtree
+}	// namespace cyclone
@@ -0,0 +1,145 @@
+#ifndef CYCLONE_SYNTAXTREE_GREENNODE_H__
+#define CYCLONE_SYNTAXTREE_GREENNODE_H__
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <cyclone/syntaxtree/Node.h>
+#include <cyclone/syntaxtree/Token.h>
+
+namespace cyclone {
+namespace syntaxtree {
+
+/**
+ * An immutable node of a syntax tree that doesn't know its position: a token, or a node
+ * type and children, and the length of the text it covers. Equal subtrees can be the
+ * same object, within a tree, between versions of a tree and between files. See
+ * GreenNodeCache for making them, and RedNode for positions and parents.
+ */
+class GreenNode {
+public:
+
+	typedef std::shared_ptr<const GreenNode>	Ptr;
+
+	explicit GreenNode (const Token & token);
+	GreenNode (NodeType type, std::vector<Ptr> && nodes);
+
+	bool isTerminal () const {
+		return m_isTerminal;
+	}
+
+	// The type of a node, ERROR for terminals:
+	NodeType type () const {
+		return m_type;
+	}
+
+	// The token of a terminal:
+	const Token & token () const {
+		return m_token;
+	}
+
+	std::size_t length () const {
+		return m_length;
+	}
+
+	std::size_t nodeCount () const {
+		return m_nodes.size ();
+	}
+
+	const Ptr & node (std::size_t i) const {
+		return m_nodes[i].node;
+	}
+
+	// Of child i, relative to the start of this node:
+	std::size_t offset (std::size_t i) const {
+		return m_nodes[i].offset;
+	}
+
+	// The index of the child that contains offset (relative to this node), by binary
+	// search. nodeCount () when the offset is at or past the end:
+	std::size_t indexAt (std::size_t offset) const;
+
+	// Of the contents, children by identity:
+	std::size_t hash () const {
+		return m_hash;
+	}
+
+	static std::size_t hash (const Token & token);
+	static std::size_t hash (NodeType type, const std::vector<Ptr> & nodes);
+
+	bool equals (const Token & token) const;
+	bool equals (NodeType type, const std::vector<Ptr> & nodes) const;
+
+private:
+
+	struct Child {
+		Ptr			node;
+		std::size_t	offset;
+	};
+
+	Token				m_token;
+	NodeType			m_type;
+	bool				m_isTerminal;
+	std::size_t			m_length;
+	std::size_t			m_hash;
+	std::vector<Child>	m_nodes;
+};
+
+/**
+ * Makes green nodes, returning the existing node for equal contents (hash-consing).
+ * Since children are compared by identity, this is cheap at every level, and an
+ * unchanged subtree of a new version of a tree is the node of the old version. The cache
+ * doesn't keep its nodes alive: the memory for the versions of a tree that are in use is
+ * that of one version plus the nodes that changed, and released versions are swept from
+ * the cache as it grows. Not thread safe.
+ */
+class GreenNodeCache {
+public:
+
+	GreenNodeCache ();
+
+	GreenNode::Ptr terminal (const Token & token);
+	GreenNode::Ptr node (NodeType type, std::vector<GreenNode::Ptr> && nodes);
+
+	/**
+	 * Converts a tree of the parser. The cache remembers the converted declarations
+	 * (without keeping them or their green nodes alive), the ones that a reparsed tree
+	 * shares with a converted tree aren't visited again. Lazy nodes are parsed, and
+	 * converted as their nodes.
+	 */
+	GreenNode::Ptr convert (const std::shared_ptr<NodeBase> & node);
+
+	// The number of distinct nodes that are alive:
+	std::size_t size () const;
+
+	void clear ();
+
+private:
+
+	struct Converted {
+		std::weak_ptr<NodeBase>			node;
+		std::weak_ptr<const GreenNode>	green;
+	};
+
+	// By hash:
+	typedef std::unordered_multimap<std::size_t, std::weak_ptr<const GreenNode>>	Map;
+	typedef std::unordered_map<const NodeBase *, Converted>							ConvertedMap;
+
+	// Entries of released nodes are swept when the maps reach this size:
+	static const std::size_t	minimumSweepSize;
+
+	void insert (std::size_t hash, const GreenNode::Ptr & node);
+
+	// Removes the entries of released nodes:
+	void sweep ();
+	void sweepIfFull ();
+
+	Map				m_nodes;
+	ConvertedMap	m_converted;
+	std::size_t		m_sweepSize;
+};
+
+}	// namespace syntaxtree
+}	// namespace cyclone
+
+#endif	// CYCLONE_SYNTAXTREE_GREENNODE_H__
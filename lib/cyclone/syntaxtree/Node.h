@@ -2,6 +2,7 @@
 #define CYCLONE_SYNTAXTREE_NODE_H__
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <cyclone/syntaxtree/Token.h>
 
@@ -14,7 +15,10 @@ enum class NodeType {
 	COMPILATION_UNIT,
 	NAMESPACE,
 	USING,
-	SCOPED_NAME
+	SCOPED_NAME,
+
+	// The body of a namespace between the braces, when it is parsed lazily:
+	NAMESPACE_BODY
 };
 
 class NodeBase {
@@ -25,12 +29,17 @@ public:
 	virtual std::size_t length () const = 0;
 	virtual bool isTerminal () const = 0;
 	virtual bool isNode () const = 0;
+
+	// A LazyNode, neither a terminal nor a node until it is parsed:
+	virtual bool isLazy () const {
+		return false;
+	}
 };
 
 class Node : public NodeBase {
 public:
 
-	Node (NodeType type) : m_nodeType (type) {
+	Node (NodeType type) : m_nodeType (type), m_length (0) {
 	}
 
 	virtual std::size_t length () const {
@@ -38,16 +47,54 @@ public:
 	}
 
 	void addNode (const std::shared_ptr<NodeBase> & node) {
-		m_nodes.push_back (node);
+		Child child = { node, m_length };
+		m_nodes.push_back (child);
 		m_length += node->length ();
 	}
 
+	// Used to copy the path to a reparsed node, the replaced node stays valid in the old tree:
+	void replaceNode (unsigned i, const std::shared_ptr<NodeBase> & node) {
+		std::size_t oldLength = m_nodes[i].node->length ();
+		m_length = m_length - oldLength + node->length ();
+		m_nodes[i].node = node;
+
+		for (unsigned j = i + 1; j < m_nodes.size (); ++ j) {
+			m_nodes[j].offset = m_nodes[j].offset - oldLength + node->length ();
+		}
+	}
+
 	unsigned nodeCount () const {
 		return m_nodes.size ();
 	}
 
 	std::shared_ptr<NodeBase> node (unsigned i) const {
-		return m_nodes[i];
+		return m_nodes[i].node;
+	}
+
+	// Of child i, relative to the start of this node:
+	std::size_t offset (unsigned i) const {
+		return m_nodes[i].offset;
+	}
+
+	// The index of the child that contains offset (relative to this node), by binary
+	// search. nodeCount () when the offset is at or past the end:
+	unsigned indexAt (std::size_t offset) const {
+		if (offset >= m_length) {
+			return m_nodes.size ();
+		}
+
+		// The last child that starts at or before offset, an empty child starts with the next:
+		unsigned begin = 0;
+		unsigned end = m_nodes.size ();
+		while (end - begin > 1) {
+			unsigned middle = begin + (end - begin) / 2;
+			if (m_nodes[middle].offset <= offset) {
+				begin = middle;
+			} else {
+				end = middle;
+			}
+		}
+		return begin;
 	}
 
 	NodeType type () const {
@@ -59,9 +106,14 @@ public:
 
 private:
 
-	NodeType								m_nodeType;
-	std::vector<std::shared_ptr<NodeBase>>	m_nodes;
-	std::size_t								m_length;
+	struct Child {
+		std::shared_ptr<NodeBase>	node;
+		std::size_t					offset;
+	};
+
+	NodeType			m_nodeType;
+	std::vector<Child>	m_nodes;
+	std::size_t			m_length;
 };
 
 class Terminal: public NodeBase {
@@ -86,6 +138,42 @@ private:
 	Token	m_token;
 };
 
+/**
+ * A node that is only parsed when it is first asked for, such as the body of a namespace
+ * in an outline. It covers the same text as the node it stands for. The node is parsed
+ * once, also when several threads ask for it at the same time.
+ */
+class LazyNode : public NodeBase {
+public:
+
+	explicit LazyNode (std::size_t length) : m_length (length) {
+	}
+
+	virtual std::size_t length () const {
+		return m_length;
+	}
+
+	virtual bool isTerminal () const { return false; }
+	virtual bool isNode () const { return false; }
+	virtual bool isLazy () const { return true; }
+
+	std::shared_ptr<Node> node () const {
+		std::call_once (m_parsed, [this] () { m_node = parse (); });
+		return m_node;
+	}
+
+protected:
+
+	// The node, of length () characters:
+	virtual std::shared_ptr<Node> parse () const = 0;
+
+private:
+
+	std::size_t						m_length;
+	mutable std::once_flag			m_parsed;
+	mutable std::shared_ptr<Node>	m_node;
+};
+
 }	// namespace syntaxtree
 }	// namespace cyclone
 
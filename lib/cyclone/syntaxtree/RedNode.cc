@@ -0,0 +1,26 @@
+#include <cyclone/syntaxtree/RedNode.h>
+
+namespace cyclone {
+namespace syntaxtree {
+
+	RedNode RedNode :: nextSibling () const {
+		if (m_parent == nullptr || m_index + 1 >= m_parent->nodeCount ()) {
+			return RedNode ();
+		}
+		return m_parent->node (m_index + 1);
+	}
+
+	RedNode RedNode :: nodeAt (std::size_t offset) const {
+		if (offset < m_offset || m_green->isTerminal ()) {
+			return RedNode ();
+		}
+
+		std::size_t i = m_green->indexAt (offset - m_offset);
+		if (i == m_green->nodeCount ()) {
+			return RedNode ();
+		}
+		return node (i);
+	}
+
+}	// namespace syntaxtree
+}	// namespace cyclone
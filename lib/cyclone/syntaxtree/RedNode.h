@@ -0,0 +1,88 @@
+#ifndef CYCLONE_SYNTAXTREE_REDNODE_H__
+#define CYCLONE_SYNTAXTREE_REDNODE_H__
+
+#include <cyclone/syntaxtree/GreenNode.h>
+
+namespace cyclone {
+namespace syntaxtree {
+
+/**
+ * A cursor on a green node at a position in a tree: its offset in the text, its index and
+ * its parent. A red node is a small value that is made while walking down from the root,
+ * without allocating. A child refers to the red node it was made from, which has to
+ * outlive it, and neither keeps the green tree alive. The green tree can be shared by any
+ * number of red trees.
+ */
+class RedNode {
+public:
+
+	RedNode ()
+		: m_green (nullptr), m_parent (nullptr), m_offset (0), m_index (0) {
+	}
+
+	// The root of a tree, at offset 0:
+	explicit RedNode (const GreenNode & root)
+		: m_green (&root), m_parent (nullptr), m_offset (0), m_index (0) {
+	}
+
+	bool isNull () const {
+		return m_green == nullptr;
+	}
+
+	const GreenNode & green () const {
+		return *m_green;
+	}
+
+	std::size_t offset () const {
+		return m_offset;
+	}
+
+	std::size_t endOffset () const {
+		return m_offset + m_green->length ();
+	}
+
+	bool hasParent () const {
+		return m_parent != nullptr;
+	}
+
+	// A null node for the root:
+	RedNode parent () const {
+		return m_parent != nullptr ? *m_parent : RedNode ();
+	}
+
+	// The index of the node in its parent:
+	std::size_t index () const {
+		return m_index;
+	}
+
+	std::size_t nodeCount () const {
+		return m_green->nodeCount ();
+	}
+
+	RedNode node (std::size_t i) const {
+		return RedNode (*m_green->node (i), this, m_offset + m_green->offset (i), i);
+	}
+
+	// A null node after the last child:
+	RedNode nextSibling () const;
+
+	// The child that contains offset, by binary search, or a null node when the offset is
+	// out of range or this is a terminal. Called on the child again for deeper nodes:
+	RedNode nodeAt (std::size_t offset) const;
+
+private:
+
+	RedNode (const GreenNode & green, const RedNode * parent, std::size_t offset, std::size_t index)
+		: m_green (&green), m_parent (parent), m_offset (offset), m_index (index) {
+	}
+
+	const GreenNode *	m_green;
+	const RedNode *		m_parent;
+	std::size_t			m_offset;
+	std::size_t			m_index;
+};
+
+}	// namespace syntaxtree
+}	// namespace cyclone
+
+#endif	// CYCLONE_SYNTAXTREE_REDNODE_H__
@@ -0,0 +1,38 @@
+#include <cyclone/syntaxtree/SyntaxTree.h>
+
+namespace cyclone {
+namespace syntaxtree {
+
+	SyntaxTree::Path SyntaxTree :: pathAt (std::size_t offset) const {
+		Path path;
+		path.reserve (8);
+		if (!m_root || offset >= m_root->length ()) {
+			return path;
+		}
+
+		PathEntry entry;
+		entry.node = m_root;
+		entry.offset = 0;
+		entry.index = 0;
+		path.push_back (entry);
+
+		while (!entry.node->isTerminal ()) {
+			// A lazy node is parsed, and is replaced by its node on the path:
+			if (entry.node->isLazy ()) {
+				entry.node = static_cast<const LazyNode &> (*entry.node).node ();
+				path.back ().node = entry.node;
+			}
+
+			const Node & node = static_cast<const Node &> (*entry.node);
+			unsigned i = node.indexAt (offset - entry.offset);
+
+			entry.offset += node.offset (i);
+			entry.node = node.node (i);
+			entry.index = i;
+			path.push_back (entry);
+		}
+		return path;
+	}
+
+}	// namespace syntaxtree
+}	// namespace cyclone
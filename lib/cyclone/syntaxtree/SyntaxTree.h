@@ -2,6 +2,7 @@
 #define CYCLONE_SYNTAXTREE_SYNTAXTREE_H__
 
 #include <memory>
+#include <vector>
 #include <cyclone/syntaxtree/Node.h>
 
 namespace cyclone {
@@ -9,16 +10,48 @@ namespace syntaxtree {
 
 class SyntaxTree {
 public:
-	SyntaxTree (const std::shared_ptr<Node> & root) : m_root (root) {
+
+	// A node on the path to an offset:
+	struct PathEntry {
+		std::shared_ptr<NodeBase>	node;
+		std::size_t					offset;	// Of the node in the text
+		unsigned					index;	// Of the node in its parent, 0 for the root
+	};
+
+	typedef std::vector<PathEntry>	Path;
+
+	SyntaxTree (const std::shared_ptr<Node> & root, bool complete = true, bool lazy = false)
+		: m_root (root), m_complete (complete), m_lazy (lazy) {
 	}
 
+	// Null when the parser reported the tree to a TreeBuilder of its own:
 	std::shared_ptr<Node> root () const {
 		return m_root;
 	}
 
+	// False when the parse was cancelled, the tree then covers a prefix of the text:
+	bool isComplete () const {
+		return m_complete;
+	}
+
+	// Whether the bodies of namespaces are LazyNodes:
+	bool isLazy () const {
+		return m_lazy;
+	}
+
+	/**
+	 * The nodes that contain offset, from the root down to a terminal. Each level is a
+	 * binary search over the offsets of the children, O(depth · log fanout). Empty when
+	 * the offset is at or past the end of the tree, or there is no root. Lazy nodes on the
+	 * path are parsed, and the path holds their nodes.
+	 */
+	Path pathAt (std::size_t offset) const;
+
 private:
 
 	std::shared_ptr<Node>	m_root;
+	bool					m_complete;
+	bool					m_lazy;
 };
 
 }
@@ -1,6 +1,9 @@
 #ifndef CYCLONE_SYNTAXTREE_TOKEN_H__
 #define CYCLONE_SYNTAXTREE_TOKEN_H__
 
+#include <cstddef>
+#include <cstdint>
+
 namespace cyclone {
 namespace syntaxtree {
 
@@ -84,16 +87,28 @@ enum class TokenError : unsigned char {
 class Token {
 public:
 
+	Token ()
+		: m_length (0), m_symbol (0), m_type (TokenType::END_OF_INPUT), m_error (TokenError::NO_ERROR), m_hasLineBreak (false) {
+	}
+
 	Token (TokenType type, std::size_t length)
-		: m_type (type), m_error (TokenError::NO_ERROR), m_length (length), m_hasLineBreak (false) {
+		: m_length (length), m_symbol (0), m_type (type), m_error (TokenError::NO_ERROR), m_hasLineBreak (false) {
 	}
 
 	Token (TokenType type, std::size_t length, bool hasLineBreak)
-		: m_type (type), m_error (TokenError::NO_ERROR), m_length (length), m_hasLineBreak (hasLineBreak) {
+		: m_length (length), m_symbol (0), m_type (type), m_error (TokenError::NO_ERROR), m_hasLineBreak (hasLineBreak) {
 	}
 
 	Token (TokenType type, TokenError error, std::size_t length)
-		: m_type (type), m_error (error), m_length (length), m_hasLineBreak (false) {
+		: m_length (length), m_symbol (0), m_type (type), m_error (error), m_hasLineBreak (false) {
+	}
+
+	Token (TokenType type, TokenError error, std::size_t length, bool hasLineBreak)
+		: m_length (length), m_symbol (0), m_type (type), m_error (error), m_hasLineBreak (hasLineBreak) {
+	}
+
+	Token (TokenType type, TokenError error, std::size_t length, bool hasLineBreak, std::uint32_t symbol)
+		: m_length (length), m_symbol (symbol), m_type (type), m_error (error), m_hasLineBreak (hasLineBreak) {
 	}
 
 	TokenType type () const {
@@ -112,12 +127,18 @@ public:
 		return m_hasLineBreak;
 	}
 
+	// The interned name of a NAME token, 0 when the lexer didn't intern it:
+	std::uint32_t symbol () const {
+		return m_symbol;
+	}
+
 private:
 
-	TokenType	m_type;
-	TokenError	m_error;
-	std::size_t	m_length;
-	bool		m_hasLineBreak;
+	std::size_t		m_length;
+	std::uint32_t	m_symbol;
+	TokenType		m_type;
+	TokenError		m_error;
+	bool			m_hasLineBreak;
 };
 
 }	// namespace syntaxtree
@@ -0,0 +1,79 @@
+#ifndef CYCLONE_SYNTAXTREE_TREEBUILDER_H__
+#define CYCLONE_SYNTAXTREE_TREEBUILDER_H__
+
+#include <memory>
+#include <vector>
+#include <cyclone/syntaxtree/Node.h>
+#include <cyclone/syntaxtree/Token.h>
+
+namespace cyclone {
+namespace syntaxtree {
+
+/**
+ * Receives a syntax tree from the parser as events in pre-order: a node starts, its
+ * tokens and nodes follow, then it finishes. The builder decides how the tree is stored,
+ * or whether it is stored at all: a builder that only looks at the events parses in
+ * constant memory, the parser keeps the lookahead and the open rules.
+ */
+class TreeBuilder {
+public:
+
+	virtual ~TreeBuilder () {
+	}
+
+	virtual void startNode (NodeType type) = 0;
+
+	// The offset is from the start of the lexer:
+	virtual void token (const Token & token, std::size_t offset) = 0;
+
+	virtual void finishNode () = 0;
+
+	// The parser expected a token of the type at the offset, ERROR nodes follow:
+	virtual void error (TokenType, std::size_t) {
+	}
+};
+
+/**
+ * Builds a tree of Node and Terminal objects, each node is added to its parent when it
+ * finishes.
+ */
+class NodeBuilder : public TreeBuilder {
+public:
+
+	virtual void startNode (NodeType type) {
+		m_nodes.push_back (std::make_shared<Node> (type));
+	}
+
+	virtual void token (const Token & token, std::size_t) {
+		m_nodes.back ()->addNode (std::make_shared<Terminal> (token));
+	}
+
+	virtual void finishNode () {
+		m_lastNode = m_nodes.back ();
+		m_nodes.pop_back ();
+
+		if (!m_nodes.empty ()) {
+			m_nodes.back ()->addNode (m_lastNode);
+		}
+	}
+
+	// Adds a node that was made elsewhere to the current node:
+	void addNode (const std::shared_ptr<NodeBase> & node) {
+		m_nodes.back ()->addNode (node);
+	}
+
+	// The node that finished last, the root once the tree is complete:
+	const std::shared_ptr<Node> & lastNode () const {
+		return m_lastNode;
+	}
+
+private:
+
+	std::vector<std::shared_ptr<Node>>	m_nodes;	// The started nodes
+	std::shared_ptr<Node>				m_lastNode;
+};
+
+}	// namespace syntaxtree
+}	// namespace cyclone
+
+#endif	// CYCLONE_SYNTAXTREE_TREEBUILDER_H__
@@ -0,0 +1,54 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cyclone/core/RingBuffer.h>
+
+using namespace cyclone::core;
+
+BOOST_AUTO_TEST_SUITE (TestRingBuffer)
+
+BOOST_AUTO_TEST_CASE (testCapacity) {
+	BOOST_CHECK (RingBuffer<int> (1).capacity () == 1);
+	BOOST_CHECK (RingBuffer<int> (5).capacity () == 8);
+	BOOST_CHECK (RingBuffer<int> (8).capacity () == 8);
+}
+
+BOOST_AUTO_TEST_CASE (testWrapAround) {
+	RingBuffer<int> buffer (4);
+
+	for (int i = 0; i < 100; ++ i) {
+		buffer.push_back (i);
+		buffer.push_back (i + 1000);
+
+		BOOST_CHECK (buffer.size () == 2);
+		BOOST_CHECK (buffer[0] == i);
+		BOOST_CHECK (buffer[1] == i + 1000);
+		BOOST_CHECK (buffer.pop_front () == i);
+		BOOST_CHECK (buffer.pop_front () == i + 1000);
+		BOOST_CHECK (buffer.empty ());
+	}
+
+	BOOST_CHECK (buffer.capacity () == 4);
+}
+
+BOOST_AUTO_TEST_CASE (testGrow) {
+	RingBuffer<int> buffer (4);
+
+	// Move the head so that growing has to unwrap the contents:
+	buffer.push_back (-1);
+	buffer.push_back (-1);
+	buffer.pop_front ();
+	buffer.pop_front ();
+
+	for (int i = 0; i < 10; ++ i) {
+		buffer.push_back (i);
+	}
+
+	BOOST_CHECK (buffer.capacity () == 16);
+	BOOST_CHECK (buffer.size () == 10);
+	for (int i = 0; i < 10; ++ i) {
+		BOOST_CHECK (buffer[i] == i);
+	}
+	BOOST_CHECK (buffer.front () == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,103 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cyclone/core/SymbolTable.h>
+
+using namespace cyclone::core;
+
+BOOST_AUTO_TEST_SUITE (TestSymbolTable)
+
+BOOST_AUTO_TEST_CASE (testIntern) {
+	SymbolTable symbols;
+
+	SymbolTable::Symbol a = symbols.intern (u"alpha");
+	SymbolTable::Symbol b = symbols.intern (u"beta");
+
+	BOOST_CHECK (a != SymbolTable::noSymbol);
+	BOOST_CHECK (b != SymbolTable::noSymbol);
+	BOOST_CHECK (a != b);
+	BOOST_CHECK (symbols.intern (u"alpha") == a);
+	BOOST_CHECK (symbols.intern (std::u16string (u"betamax").data (), 4) == b);
+	BOOST_CHECK (symbols.name (a) == u"alpha");
+	BOOST_CHECK (symbols.symbolHash (b) == SymbolTable::hashString (u"beta"));
+	BOOST_CHECK (symbols.find (u"beta") == b);
+	BOOST_CHECK (symbols.find (u"gamma") == SymbolTable::noSymbol);
+	BOOST_CHECK (symbols.size () == 2);
+}
+
+BOOST_AUTO_TEST_CASE (testEmptyString) {
+	SymbolTable symbols;
+
+	SymbolTable::Symbol empty = symbols.intern (u"");
+	BOOST_CHECK (empty != SymbolTable::noSymbol);
+	BOOST_CHECK (symbols.name (empty).empty ());
+}
+
+BOOST_AUTO_TEST_CASE (testStableNames) {
+	SymbolTable symbols;
+
+	SymbolTable::Symbol first = symbols.intern (u"first");
+	const std::u16string & name = symbols.name (first);
+
+	std::vector<SymbolTable::Symbol> added;
+	for (int i = 0; i < 10000; ++ i) {
+		std::string s = "name" + std::to_string (i);
+		added.push_back (symbols.intern (std::u16string (s.begin (), s.end ())));
+	}
+
+	BOOST_CHECK (&symbols.name (first) == &name);
+	BOOST_CHECK (name == u"first");
+	BOOST_CHECK (symbols.size () == 10001);
+
+	for (int i = 0; i < 10000; ++ i) {
+		std::string s = "name" + std::to_string (i);
+		BOOST_CHECK (symbols.name (added[i]) == std::u16string (s.begin (), s.end ()));
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testConcurrentIntern) {
+	SymbolTable symbols;
+	const int threadCount = 4;
+	const int nameCount = 5000;
+	std::vector<std::vector<SymbolTable::Symbol>> results (threadCount);
+	std::vector<std::thread> threads;
+
+	// All threads intern the same names in different orders:
+	for (int t = 0; t < threadCount; ++ t) {
+		threads.push_back (std::thread ([&symbols, &results, t, nameCount] () {
+			results[t].resize (nameCount);
+			for (int n = 0; n < nameCount; ++ n) {
+				int i = (n + t * 1237) % nameCount;
+				std::string s = "n" + std::to_string (i);
+				results[t][i] = symbols.intern (std::u16string (s.begin (), s.end ()));
+			}
+		}));
+	}
+
+	// Memory usage can be read while strings are interned:
+	std::atomic<bool> done (false);
+	std::size_t usage = 0;
+	std::thread reader ([&symbols, &done, &usage] () {
+		while (!done.load ()) {
+			usage = std::max (usage, symbols.memoryUsage ());
+		}
+	});
+
+	for (std::thread & thread: threads) {
+		thread.join ();
+	}
+	done.store (true);
+	reader.join ();
+
+	BOOST_CHECK (usage <= symbols.memoryUsage ());
+	BOOST_CHECK (symbols.size () == std::size_t (nameCount));
+	for (int t = 1; t < threadCount; ++ t) {
+		BOOST_CHECK (results[t] == results[0]);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -204,5 +204,54 @@ BOOST_AUTO_TEST_CASE (testBalanceAppend) {
 	BOOST_CHECK (cyclone::core::internal::TextBufferNodeBase::m_nodeCount == 0);
 }
 
+BOOST_AUTO_TEST_CASE (testMemoryStats) {
+	TextBuffer empty;
+	TextBufferMemoryStats emptyStats = empty.memoryStats ();
+
+	BOOST_CHECK (emptyStats.leafCount == 1);
+	BOOST_CHECK (emptyStats.innerNodeCount == 0);
+	BOOST_CHECK (emptyStats.depth == 1);
+	BOOST_CHECK (emptyStats.leafSizeHistogram[0] == 1);
+
+	// 2000 characters are split into 4 leaves of 500 characters:
+	TextBuffer buffer (std::u16string (2000, u'a'));
+	TextBufferMemoryStats stats = buffer.memoryStats ();
+
+	BOOST_CHECK (stats.leafCount == 4);
+	BOOST_CHECK (stats.innerNodeCount == 3);
+	BOOST_CHECK (stats.depth == 3);
+	BOOST_CHECK (stats.characterCount == 2000);
+	BOOST_CHECK (stats.leafSizeHistogram[9] == 4);
+	BOOST_CHECK (stats.leafBytes >= 2000 * sizeof (char16_t));
+	BOOST_CHECK (stats.innerNodeBytes > 0);
+	BOOST_CHECK (stats.totalBytes () == stats.leafBytes + stats.innerNodeBytes);
+}
+
+BOOST_AUTO_TEST_CASE (testMemoryAccounting) {
+	TextBuffer original (std::u16string (2000, u'a'));
+	TextBuffer edited = original.splice (1000, 10, u"bbbb");
+
+	TextBufferMemoryStats originalStats = original.memoryStats ();
+	TextBufferMemoryStats editedStats = edited.memoryStats ();
+
+	TextBufferMemoryAccounting accounting;
+	TextBufferMemoryStats first = accounting.add (original);
+	TextBufferMemoryStats second = accounting.add (edited);
+
+	BOOST_CHECK (first.totalBytes () == originalStats.totalBytes ());
+
+	// The edit shares the untouched leaves with the original:
+	BOOST_CHECK (second.totalBytes () < editedStats.totalBytes ());
+	BOOST_CHECK (second.leafCount < editedStats.leafCount);
+	BOOST_CHECK (second.depth == editedStats.depth);
+	BOOST_CHECK (accounting.total ().totalBytes () == first.totalBytes () + second.totalBytes ());
+
+	// Adding a buffer again doesn't count anything:
+	BOOST_CHECK (accounting.add (edited).totalBytes () == 0);
+
+	// A subtree that occurs twice in the same tree is counted once:
+	TextBuffer doubled = original.append (original);
+	BOOST_CHECK (doubled.memoryStats ().leafCount == originalStats.leafCount);
+}
 
 BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,47 @@
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <future>
+#include <vector>
+#include <cyclone/core/ThreadPool.h>
+
+using namespace cyclone::core;
+
+BOOST_AUTO_TEST_SUITE (TestThreadPool)
+
+BOOST_AUTO_TEST_CASE (testSubmit) {
+	ThreadPool pool (4);
+
+	BOOST_CHECK (pool.threadCount () == 4);
+
+	std::vector<std::future<int>> results;
+	for (int i = 0; i < 100; ++ i) {
+		results.push_back (pool.submit ([i] () { return i * i; }));
+	}
+
+	for (int i = 0; i < 100; ++ i) {
+		BOOST_CHECK (results[i].get () == i * i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testException) {
+	ThreadPool pool (2);
+
+	std::future<int> result = pool.submit ([] () -> int { throw std::runtime_error ("failed"); });
+
+	BOOST_CHECK_THROW (result.get (), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (testDestroyRunsQueuedTasks) {
+	std::atomic<int> count (0);
+	{
+		ThreadPool pool (1);
+		for (int i = 0; i < 50; ++ i) {
+			pool.submit ([&count] () { ++ count; });
+		}
+	}
+
+	BOOST_CHECK (count == 50);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,168 @@
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/Utf8.h>
+#include <utf8/utf8.h>
+
+using namespace cyclone::core;
+
+static const Utf8::Kernel kernels[] = { Utf8::Kernel::SCALAR, Utf8::Kernel::SSE2, Utf8::Kernel::AVX2 };
+
+// Random text with runs of ASCII of all lengths between other characters:
+static std::u16string randomText (std::mt19937 & random, std::size_t length) {
+	std::u16string text;
+	while (text.length () < length) {
+		switch (random () % 5) {
+			case 0:
+				text += char16_t (0x80 + random () % (0x800 - 0x80));
+				break;
+			case 1:
+				text += char16_t (0xe000 + random () % 0x2000);
+				break;
+			case 2: {
+				std::uint32_t c = random () % 0x100000;
+				text += char16_t (0xd800 + (c >> 10));
+				text += char16_t (0xdc00 + (c & 0x3ff));
+				break;
+			}
+			default:
+				for (std::size_t n = random () % 70; n > 0; -- n) {
+					text += char16_t (1 + random () % 127);
+				}
+				break;
+		}
+	}
+	return text;
+}
+
+BOOST_AUTO_TEST_SUITE (TestUtf8)
+
+BOOST_AUTO_TEST_CASE (testScalarAlwaysSupported) {
+	BOOST_CHECK (Utf8::isSupported (Utf8::Kernel::SCALAR));
+	BOOST_CHECK (Utf8::isSupported (Utf8::bestKernel ()));
+}
+
+BOOST_AUTO_TEST_CASE (testRoundTrip) {
+	std::mt19937 random (11);
+
+	for (int round = 0; round < 500; ++ round) {
+		std::u16string text = randomText (random, round);
+		std::string expected;
+		utf8::utf16to8 (text.begin (), text.end (), std::back_inserter (expected));
+
+		for (Utf8::Kernel kernel: kernels) {
+			std::string encoded ("prefix");
+			BOOST_REQUIRE (Utf8::fromUtf16 (text.data (), text.length (), encoded, kernel));
+			BOOST_CHECK (encoded == "prefix" + expected);
+
+			std::u16string decoded (u"prefix");
+			BOOST_REQUIRE (Utf8::toUtf16 (expected.data (), expected.length (), decoded, kernel));
+			BOOST_CHECK (decoded == u"prefix" + text);
+			BOOST_CHECK (Utf8::isValid (expected.data (), expected.length (), kernel));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testInvalidUtf8) {
+	std::mt19937 random (13);
+
+	for (int round = 0; round < 5000; ++ round) {
+		std::u16string text = randomText (random, 1 + random () % 100);
+		std::string bytes;
+		utf8::utf16to8 (text.begin (), text.end (), std::back_inserter (bytes));
+
+		// Damage a few bytes:
+		for (std::size_t n = random () % 3; n > 0; -- n) {
+			bytes[random () % bytes.length ()] = char (random () % 256);
+		}
+		if (random () % 4 == 0) {
+			bytes.resize (random () % (bytes.length () + 1));
+		}
+
+		bool expected = utf8::is_valid (bytes.begin (), bytes.end ());
+		for (Utf8::Kernel kernel: kernels) {
+			std::u16string decoded;
+			BOOST_CHECK (Utf8::isValid (bytes.data (), bytes.length (), kernel) == expected);
+			BOOST_CHECK (Utf8::toUtf16 (bytes.data (), bytes.length (), decoded, kernel) == expected);
+
+			if (expected) {
+				std::u16string oracle;
+				utf8::utf8to16 (bytes.begin (), bytes.end (), std::back_inserter (oracle));
+				BOOST_CHECK (decoded == oracle);
+			}
+		}
+	}
+
+	// Overlong, surrogate, beyond U+10FFFF and truncated:
+	const char * invalid[] = { "\xc0\xaf", "\xe0\x80\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xe2\x82", "\x80" };
+	for (const char * s: invalid) {
+		BOOST_CHECK (!Utf8::isValid (s, std::char_traits<char>::length (s)));
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testBlockBoundaries) {
+	// Every kind of sequence and error at every position of two blocks, after ASCII or
+	// after other sequences:
+	const char * sequences[] = { "\xc3\xa9", "\xe4\xb8\xad", "\xf0\x9f\x98\x80", "\xe0\xa0\x80", "\xed\x9f\xbf",
+		"\xf4\x8f\xbf\xbf", "\xc1\xbf", "\xe0\x9f\xbf", "\xed\xa0\x80", "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80",
+		"\xf5\x80\x80\x80", "\xc3", "\xe4\xb8", "\xf0\x9f\x98", "\x80", "\xc3\xa9\x80", "\xe4\xb8\xad\xad" };
+	const std::string fillers[] = { "a", "\xc3\xa9", "\xe4\xb8\xad" };
+
+	for (const char * sequence: sequences) {
+		for (const std::string & filler: fillers) {
+			for (std::size_t position = 0; position < 70; ++ position) {
+				std::string bytes;
+				while (bytes.length () < position) {
+					bytes += filler;
+				}
+				bytes += sequence;
+				std::size_t sequenceEnd = bytes.length ();
+				while (bytes.length () < sequenceEnd + 70) {
+					bytes += filler;
+				}
+
+				for (std::size_t length: { sequenceEnd, bytes.length () }) {
+					bool expected = utf8::is_valid (bytes.begin (), bytes.begin () + length);
+					for (Utf8::Kernel kernel: kernels) {
+						BOOST_CHECK (Utf8::isValid (bytes.data (), length, kernel) == expected);
+					}
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testUnpairedSurrogates) {
+	const std::u16string invalid[] = { u"abc\xd800", u"\xdc00" u"abc", u"a\xd800" u"b", u"\xd800\xd800\xdc00" };
+
+	for (const std::u16string & text: invalid) {
+		for (Utf8::Kernel kernel: kernels) {
+			std::string result;
+			BOOST_CHECK (!Utf8::fromUtf16 (text.data (), text.length (), result, kernel));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testTextBuffer) {
+	std::string source ("namespace caf\xc3\xa9 { \xf0\x9f\x98\x80 }");
+	TextBuffer buffer = TextBuffer::fromUtf8 (source);
+
+	BOOST_CHECK (buffer.toString () == u"namespace café { \U0001F600 }");
+	BOOST_CHECK (buffer.toUtf8 () == source);
+	BOOST_CHECK_THROW (TextBuffer::fromUtf8 ("\xff"), std::invalid_argument);
+
+	// Every character in its own leaf, the surrogate pair is split:
+	TextBuffer split;
+	for (char16_t c: buffer.toString ()) {
+		split = split.append (TextBuffer (std::u16string (1, c)));
+	}
+	BOOST_CHECK (split.toUtf8 () == source);
+
+	BOOST_CHECK_THROW (TextBuffer (u"a\xd800").append (TextBuffer (u"b")).toUtf8 (), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
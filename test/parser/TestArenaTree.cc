@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/Parser.h>
+#include <cyclone/syntaxtree/ArenaTree.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+static ArenaTree parseArena (const TextBuffer & buffer) {
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	ArenaTreeBuilder builder;
+	Parser parser (lexer, builder);
+	BOOST_CHECK (parser.parseCompilationUnit () == nullptr);
+	return builder.build ();
+}
+
+static bool sameTree (const std::shared_ptr<NodeBase> & node, const ArenaTree::Node & arena) {
+	if (node->isTerminal () != arena.isTerminal () || node->length () != arena.length ()) {
+		return false;
+	}
+
+	if (node->isTerminal ()) {
+		const Token & token = std::static_pointer_cast<Terminal> (node)->token ();
+		return token.type () == arena.token ().type () && token.error () == arena.token ().error () && token.symbol () == arena.token ().symbol ();
+	}
+
+	std::shared_ptr<Node> n = std::static_pointer_cast<Node> (node);
+	if (n->type () != arena.type () || n->nodeCount () != arena.nodeCount ()) {
+		return false;
+	}
+
+	for (unsigned i = 0; i < n->nodeCount (); ++ i) {
+		if (!sameTree (n->node (i), arena.node (i))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static std::size_t countNodes (const ArenaTree::Node & node) {
+	std::size_t count = 1;
+	for (std::size_t i = 0; i < node.nodeCount (); ++ i) {
+		count += countNodes (node.node (i));
+	}
+	return count;
+}
+
+BOOST_AUTO_TEST_SUITE (TestArenaTree)
+
+BOOST_AUTO_TEST_CASE (testSameAsNodeTree) {
+	const char16_t * sources[] = {
+		u"",
+		u"using a.b; /* c */ namespace d { namespace e { using f = g; } }\n",
+		u"using a b c; namespace d { }",
+		u"namespace a { using b.c = ; \n namespace { } # }",
+		u"namespace a.b { using c;"
+	};
+
+	for (const char16_t * source: sources) {
+		TextBuffer buffer (source);
+		Lexer lexer (buffer, buffer.begin (), buffer.end ());
+		Parser parser (lexer);
+		SyntaxTree tree = parser.parse ();
+
+		ArenaTree arena = parseArena (buffer);
+		BOOST_REQUIRE (!arena.empty ());
+		BOOST_CHECK (sameTree (tree.root (), arena.root ()));
+		BOOST_CHECK (arena.root ().length () == buffer.length ());
+		BOOST_CHECK (countNodes (arena.root ()) == arena.size ());
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testMove) {
+	ArenaTree arena = parseArena (TextBuffer (u"namespace a { using b; }"));
+	const ArenaTree::Node * root = &arena.root ();
+
+	// Moving keeps the nodes where they are:
+	ArenaTree moved (std::move (arena));
+	BOOST_CHECK (&moved.root () == root);
+	BOOST_CHECK (moved.root ().node (0).type () == NodeType::NAMESPACE);
+	BOOST_CHECK (moved.root ().node (0).node (0).token ().type () == TokenType::NAMESPACE);
+}
+
+BOOST_AUTO_TEST_CASE (testInvalidEvents) {
+	ArenaTreeBuilder builder;
+	BOOST_CHECK (builder.build ().empty ());
+
+	builder.startNode (NodeType::USING);
+	BOOST_CHECK_THROW (builder.build (), std::logic_error);
+
+	ArenaTreeBuilder twoRoots;
+	twoRoots.startNode (NodeType::USING);
+	twoRoots.finishNode ();
+	twoRoots.startNode (NodeType::USING);
+	twoRoots.finishNode ();
+	BOOST_CHECK_THROW (twoRoots.build (), std::logic_error);
+
+	ArenaTreeBuilder token;
+	token.token (Token (TokenType::NAME, 1), 0);
+	BOOST_CHECK_THROW (token.build (), std::logic_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
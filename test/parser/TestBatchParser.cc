@@ -0,0 +1,204 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/ThreadPool.h>
+#include <cyclone/parser/BatchParser.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/Parser.h>
+#include "TreeComparison.h"
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+namespace {
+	// Files in a new directory, removed at the end of the test:
+	class TemporaryFiles {
+	public:
+
+		TemporaryFiles () {
+			char pattern[] = "/tmp/TestBatchParserXXXXXX";
+			if (mkdtemp (pattern) == nullptr) {
+				throw std::runtime_error ("mkdtemp");
+			}
+			m_directory = pattern;
+		}
+
+		~TemporaryFiles () {
+			for (const std::string & path: m_paths) {
+				std::remove (path.c_str ());
+			}
+			rmdir (m_directory.c_str ());
+		}
+
+		std::string add (const std::string & content) {
+			std::string path = m_directory + "/" + std::to_string (m_paths.size ()) + ".cy";
+			std::ofstream out (path.c_str (), std::ios::binary);
+			out << content;
+			m_paths.push_back (path);
+			return path;
+		}
+
+		std::string missing () const {
+			return m_directory + "/missing.cy";
+		}
+
+	private:
+
+		std::string					m_directory;
+		std::vector<std::string>	m_paths;
+	};
+
+	std::string source (int blocks) {
+		std::string text;
+		for (int i = 0; i < blocks; ++ i) {
+			text += "namespace a" + std::to_string (i) + " {\n\tusing b.c;\n\tnamespace d { using e = f; }\n}\n";
+		}
+		return text;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE (TestBatchParser)
+
+BOOST_AUTO_TEST_CASE (testParse) {
+	TemporaryFiles files;
+	std::vector<std::string> paths;
+	std::vector<std::string> sources;
+	for (int i = 0; i < 20; ++ i) {
+		// Lengths are in UTF-16 code units, not bytes:
+		sources.push_back (source ((i * 7) % 13) + "// \xc3\xa9 \xf0\x9f\x98\x80\n");
+		paths.push_back (files.add (sources.back ()));
+	}
+	paths.push_back (files.missing ());
+	paths.push_back (files.add ("using \xff;"));
+
+	ThreadPool pool (4);
+	BatchParser batch (pool);
+	std::mutex mutex;
+	std::vector<BatchParser::FileResult> results (paths.size ());
+
+	BatchParser::Statistics statistics = batch.parse (paths, [&] (BatchParser::FileResult & result) {
+		std::lock_guard<std::mutex> lock (mutex);
+		results[result.index] = result;
+	});
+
+	BOOST_CHECK (statistics.fileCount == paths.size ());
+	BOOST_CHECK (statistics.failedCount == 2);
+
+	std::size_t bytes = 0;
+	for (std::size_t i = 0; i < sources.size (); ++ i) {
+		BOOST_REQUIRE (results[i].root);
+		BOOST_CHECK (results[i].path == paths[i]);
+		BOOST_CHECK (results[i].bytes == sources[i].size ());
+		BOOST_CHECK (results[i].error.empty ());
+		BOOST_REQUIRE (results[i].file);
+		BOOST_CHECK (std::string (results[i].file->data (), results[i].file->size ()) == sources[i]);
+
+		TextBuffer text = TextBuffer::fromUtf8 (sources[i]);
+		Lexer lexer (text, text.begin (), text.end ());
+		Parser parser (lexer);
+		BOOST_CHECK (sameTree (results[i].root, parser.parseCompilationUnit ()));
+		bytes += sources[i].size ();
+	}
+	BOOST_CHECK (statistics.bytes == bytes + 8);
+
+	// A missing file and invalid UTF-8:
+	BOOST_CHECK (!results[20].root);
+	BOOST_CHECK (!results[20].file);
+	BOOST_CHECK (!results[20].error.empty ());
+	BOOST_CHECK (!results[21].root);
+	BOOST_CHECK (!results[21].file);
+	BOOST_CHECK (!results[21].error.empty ());
+}
+
+BOOST_AUTO_TEST_CASE (testOrderAndMemoryBound) {
+	TemporaryFiles files;
+	std::vector<std::string> paths;
+	std::size_t largest = 0;
+	for (int i = 0; i < 12; ++ i) {
+		std::string text = source ((i * 5) % 12 + 1);
+		largest = std::max (largest, text.size ());
+		paths.push_back (files.add (text));
+	}
+
+	// With one thread, the files come largest first:
+	{
+		ThreadPool pool (1);
+		BatchParser batch (pool);
+		std::vector<std::size_t> sizes;
+		batch.parse (paths, [&] (BatchParser::FileResult & result) {
+			sizes.push_back (result.bytes);
+		});
+		BOOST_REQUIRE (sizes.size () == paths.size ());
+		for (std::size_t i = 1; i < sizes.size (); ++ i) {
+			BOOST_CHECK (sizes[i - 1] >= sizes[i]);
+		}
+	}
+
+	// The files in flight stay within the bound, which is less than two of the largest:
+	{
+		ThreadPool pool (4);
+		BatchParser batch (pool, largest + largest / 2);
+		std::mutex mutex;
+		std::size_t inFlight = 0;
+		std::size_t maxInFlight = 0;
+
+		BatchParser::Statistics statistics = batch.parse (paths, [&] (BatchParser::FileResult & result) {
+			{
+				std::lock_guard<std::mutex> lock (mutex);
+				inFlight += result.bytes;
+				maxInFlight = std::max (maxInFlight, inFlight);
+			}
+			usleep (2000);
+			std::lock_guard<std::mutex> lock (mutex);
+			inFlight -= result.bytes;
+		});
+
+		BOOST_CHECK (statistics.fileCount == paths.size ());
+		BOOST_CHECK (maxInFlight <= batch.maxInFlightBytes ());
+		BOOST_CHECK (statistics.maxInFlightBytes <= batch.maxInFlightBytes ());
+	}
+
+	// A file larger than the bound still runs, on its own:
+	{
+		ThreadPool pool (2);
+		BatchParser batch (pool, 1);
+		BatchParser::Statistics statistics = batch.parse (paths, [] (BatchParser::FileResult &) { });
+		BOOST_CHECK (statistics.fileCount == paths.size ());
+		BOOST_CHECK (statistics.maxInFlightBytes == largest);
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testCallbackException) {
+	TemporaryFiles files;
+	std::vector<std::string> paths;
+	for (int i = 0; i < 5; ++ i) {
+		paths.push_back (files.add (source (i + 1)));
+	}
+
+	ThreadPool pool (2);
+	BatchParser batch (pool);
+	std::mutex mutex;
+	std::size_t calls = 0;
+
+	BOOST_CHECK_THROW (batch.parse (paths, [&] (BatchParser::FileResult & result) {
+		{
+			std::lock_guard<std::mutex> lock (mutex);
+			++ calls;
+		}
+		if (result.index == 2) {
+			throw std::runtime_error ("callback");
+		}
+	}), std::runtime_error);
+	BOOST_CHECK (calls == paths.size ());
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
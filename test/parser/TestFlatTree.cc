@@ -0,0 +1,122 @@
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/Parser.h>
+#include <cyclone/syntaxtree/FlatTree.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+static SyntaxTree parse (const TextBuffer & buffer) {
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	Parser parser (lexer);
+	return parser.parse ();
+}
+
+// Writes the tree as nested lists of node and token types, and their offsets:
+static void dump (const std::shared_ptr<NodeBase> & node, std::size_t & offset, std::string & out) {
+	if (node->isTerminal ()) {
+		out += "t" + std::to_string (int (std::static_pointer_cast<Terminal> (node)->token ().type ())) + "@" + std::to_string (offset) + " ";
+		offset += node->length ();
+		return;
+	}
+
+	std::shared_ptr<Node> n = std::static_pointer_cast<Node> (node);
+	out += "(" + std::to_string (int (n->type ())) + "@" + std::to_string (offset) + " ";
+	for (unsigned i = 0; i < n->nodeCount (); ++ i) {
+		dump (n->node (i), offset, out);
+	}
+	out += ") ";
+}
+
+struct DumpVisitor {
+	std::string		out;
+	bool			skip;
+	NodeType		skipped;
+
+	DumpVisitor () : skip (false), skipped (NodeType::ERROR) {
+	}
+
+	bool enter (const FlatTree & tree, std::size_t index, std::size_t offset) {
+		if (skip && tree.entry (index).type == skipped) {
+			out += "skipped@" + std::to_string (offset) + " ";
+			return false;
+		}
+		out += "(" + std::to_string (int (tree.entry (index).type)) + "@" + std::to_string (offset) + " ";
+		return true;
+	}
+
+	void leave (const FlatTree &, std::size_t) {
+		out += ") ";
+	}
+
+	void token (const Token & token, std::size_t offset) {
+		out += "t" + std::to_string (int (token.type ())) + "@" + std::to_string (offset) + " ";
+	}
+};
+
+BOOST_AUTO_TEST_SUITE (TestFlatTree)
+
+BOOST_AUTO_TEST_CASE (testWalk) {
+	const char16_t * sources[] = {
+		u"",
+		u"using a.b; /* c */ namespace d { namespace e { using f = g; } }\n",
+		u"using a b c; namespace d { }",
+		u"namespace a.b { using c;"
+	};
+
+	for (const char16_t * source: sources) {
+		TextBuffer buffer (source);
+		SyntaxTree tree = parse (buffer);
+		FlatTree flat (tree.root ());
+
+		std::string expected;
+		std::size_t offset = 0;
+		dump (tree.root (), offset, expected);
+
+		DumpVisitor visitor;
+		flat.walk (visitor);
+		BOOST_CHECK_EQUAL (visitor.out, expected);
+
+		BOOST_CHECK (flat.skip (0) == flat.size ());
+		BOOST_CHECK (flat.entry (0).length == buffer.length ());
+		BOOST_CHECK (flat.entry (0).firstToken == 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testSkip) {
+	TextBuffer buffer (u"using a.b;\nnamespace c {\n\tusing d.e = f;\n}\n");
+	FlatTree flat (parse (buffer).root ());
+
+	// Only the name of the namespace is left:
+	DumpVisitor visitor;
+	visitor.skip = true;
+	visitor.skipped = NodeType::USING;
+	flat.walk (visitor);
+
+	std::string name ("t" + std::to_string (int (TokenType::NAME)) + "@");
+	std::size_t first = visitor.out.find (name);
+	BOOST_CHECK (first != std::string::npos);
+	BOOST_CHECK (visitor.out.find (name, first + 1) == std::string::npos);
+	BOOST_CHECK (visitor.out.find ("(1@0 skipped@0 ") == 0);
+	BOOST_CHECK (visitor.out.find ("skipped@", 6) != std::string::npos);
+
+	// The tokens of a subtree follow its first token:
+	for (std::size_t i = 0; i < flat.size (); ++ i) {
+		const FlatTree::Entry & entry = flat.entry (i);
+		std::size_t length = 0;
+		std::size_t token = entry.firstToken;
+		for (std::size_t j = i; j < flat.skip (i); ++ j) {
+			if (flat.entry (j).isTerminal) {
+				BOOST_CHECK (flat.entry (j).firstToken == token);
+				length += flat.token (token ++).length ();
+			}
+		}
+		BOOST_CHECK (length == entry.length);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
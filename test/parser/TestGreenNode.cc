@@ -0,0 +1,184 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/Parser.h>
+#include <cyclone/syntaxtree/GreenNode.h>
+#include <cyclone/syntaxtree/RedNode.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+static SyntaxTree parse (const TextBuffer & buffer) {
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	Parser parser (lexer);
+	return parser.parse ();
+}
+
+static bool sameTree (const std::shared_ptr<NodeBase> & node, const GreenNode & green) {
+	if (node->isTerminal () != green.isTerminal () || node->length () != green.length ()) {
+		return false;
+	}
+
+	if (node->isTerminal ()) {
+		return std::static_pointer_cast<Terminal> (node)->token ().type () == green.token ().type ();
+	}
+
+	std::shared_ptr<Node> n = std::static_pointer_cast<Node> (node);
+	if (n->type () != green.type () || n->nodeCount () != green.nodeCount ()) {
+		return false;
+	}
+
+	for (unsigned i = 0; i < n->nodeCount (); ++ i) {
+		if (!sameTree (n->node (i), *green.node (i))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static std::u16string repeat (const std::u16string & block, int count) {
+	std::u16string text;
+	for (int i = 0; i < count; ++ i) {
+		text += block;
+	}
+	return text;
+}
+
+BOOST_AUTO_TEST_SUITE (TestGreenNode)
+
+BOOST_AUTO_TEST_CASE (testConvert) {
+	TextBuffer buffer (u"using a.b; /* c */ namespace d { namespace e { using f = g; } }\n");
+	SyntaxTree tree = parse (buffer);
+	GreenNodeCache cache;
+
+	GreenNode::Ptr green = cache.convert (tree.root ());
+	BOOST_CHECK (sameTree (tree.root (), *green));
+	BOOST_CHECK (green->length () == buffer.length ());
+
+	// Converting again gives the same nodes:
+	BOOST_CHECK (cache.convert (tree.root ()) == green);
+	BOOST_CHECK (cache.convert (parse (buffer).root ()) == green);
+}
+
+BOOST_AUTO_TEST_CASE (testSharedSubtrees) {
+	std::u16string block (u"namespace a {\n\tusing b.c;\n\tnamespace d { using e; }\n}\n");
+	SyntaxTree tree = parse (TextBuffer (repeat (block, 100)));
+	GreenNodeCache cache;
+	GreenNode::Ptr green = cache.convert (tree.root ());
+
+	// All but the first block start with the line break after the previous one:
+	BOOST_REQUIRE (green->nodeCount () >= 100);
+	for (std::size_t i = 2; i < 100; ++ i) {
+		BOOST_CHECK (green->node (i) == green->node (1));
+	}
+	BOOST_CHECK (green->node (0) != green->node (1));
+	BOOST_CHECK (cache.size () < 50);
+}
+
+BOOST_AUTO_TEST_CASE (testVersions) {
+	std::u16string text;
+	for (int i = 0; i < 100; ++ i) {
+		text += u"namespace n" + std::u16string (1, char16_t (u'A' + i % 26)) + std::u16string (1, char16_t (u'A' + i / 26)) + u" {\n\tusing b.c;\n}\n";
+	}
+
+	TextBuffer buffer (text);
+	SyntaxTree tree = parse (buffer);
+	GreenNodeCache cache;
+	GreenNode::Ptr first = cache.convert (tree.root ());
+	std::size_t size = cache.size ();
+
+	// Each edit renames a using declaration, only the nodes on the path to it are new:
+	for (std::size_t i = 0; i < 10; ++ i) {
+		std::size_t offset = buffer.toString ().find (u"b.c");
+		buffer = buffer.splice (offset, 1, u"x");
+		tree = Parser::reparse (tree, buffer, TextEdit (offset, 1, 1));
+
+		GreenNode::Ptr green = cache.convert (tree.root ());
+		BOOST_CHECK (sameTree (tree.root (), *green));
+		BOOST_CHECK (cache.size () <= size + 5);
+		size = cache.size ();
+
+		BOOST_CHECK (green->node (99) == first->node (99));
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testReleasedVersions) {
+	TextBuffer buffer (repeat (u"namespace a {\n\tusing b.c;\n}\n", 100));
+	SyntaxTree tree = parse (buffer);
+	GreenNodeCache cache;
+	GreenNode::Ptr green = cache.convert (tree.root ());
+	std::size_t size = cache.size ();
+
+	// Each edit gives the first using declaration a new name, the nodes of the versions
+	// that were replaced are released:
+	std::size_t offset = buffer.toString ().find (u"b.c");
+	std::u16string name (u"b");
+	for (int i = 0; i < 200; ++ i) {
+		std::u16string next (u"v");
+		for (int n = i; n > 0; n /= 10) {
+			next += char16_t (u'0' + n % 10);
+		}
+
+		buffer = buffer.splice (offset, name.length (), next);
+		tree = Parser::reparse (tree, buffer, TextEdit (offset, name.length (), next.length ()));
+		name = next;
+
+		green = cache.convert (tree.root ());
+		BOOST_CHECK (sameTree (tree.root (), *green));
+		BOOST_CHECK (cache.size () <= size + 5);
+	}
+
+	green.reset ();
+	BOOST_CHECK (cache.size () == 0);
+}
+
+BOOST_AUTO_TEST_CASE (testRedNode) {
+	TextBuffer buffer (u"using a.b;\nnamespace c {\n\tusing d.e = f;\n}\n");
+	GreenNodeCache cache;
+	GreenNode::Ptr green = cache.convert (parse (buffer).root ());
+	RedNode root (*green);
+
+	BOOST_CHECK (root.offset () == 0);
+	BOOST_CHECK (root.endOffset () == buffer.length ());
+	BOOST_CHECK (!root.hasParent ());
+	BOOST_CHECK (root.parent ().isNull ());
+
+	// Children are contiguous:
+	std::size_t offset = 0;
+	for (RedNode node = root.node (0); !node.isNull (); node = node.nextSibling ()) {
+		BOOST_CHECK (node.offset () == offset);
+		BOOST_CHECK (&node.parent ().green () == green.get ());
+		BOOST_CHECK (root.node (node.index ()).offset () == offset);
+		offset = node.endOffset ();
+	}
+	BOOST_CHECK (offset == buffer.length ());
+
+	// The child at each offset contains it:
+	for (std::size_t i = 0; i < buffer.length (); ++ i) {
+		RedNode node = root.nodeAt (i);
+		BOOST_REQUIRE (!node.isNull ());
+		BOOST_CHECK (node.offset () <= i && i < node.endOffset ());
+	}
+
+	// The terminal at "e", and its ancestors:
+	std::size_t e = buffer.toString ().find (u"d.e") + 2;
+	RedNode namespaceNode = root.nodeAt (e);
+	RedNode usingNode = namespaceNode.nodeAt (e);
+	RedNode scopedName = usingNode.nodeAt (e);
+	RedNode terminal = scopedName.nodeAt (e);
+	BOOST_REQUIRE (!terminal.isNull ());
+	BOOST_CHECK (terminal.green ().isTerminal ());
+	BOOST_CHECK (terminal.green ().token ().type () == TokenType::NAME);
+	BOOST_CHECK (terminal.offset () == e);
+	BOOST_CHECK (terminal.nodeAt (e).isNull ());
+	BOOST_CHECK (terminal.parent ().green ().type () == NodeType::SCOPED_NAME);
+	BOOST_CHECK (terminal.parent ().parent ().green ().type () == NodeType::USING);
+	BOOST_CHECK (terminal.parent ().parent ().parent ().green ().type () == NodeType::NAMESPACE);
+	BOOST_CHECK (terminal.parent ().parent ().offset () <= e);
+
+	BOOST_CHECK (root.nodeAt (buffer.length ()).isNull ());
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,192 @@
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/IncrementalLexer.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+static bool sameTokens (const IncrementalLexer & incremental, const TextBuffer & buffer) {
+	IncrementalLexer expected (buffer, incremental.checkpointInterval ());
+
+	if (expected.tokenCount () != incremental.tokenCount ()) {
+		return false;
+	}
+
+	for (std::size_t i = 0; i < expected.tokenCount (); ++ i) {
+		const Token & a = expected.token (i);
+		const Token & b = incremental.token (i);
+		if (a.type () != b.type () || a.error () != b.error () || a.length () != b.length ()
+				|| a.hasLineBreak () != b.hasLineBreak () || expected.tokenOffset (i) != incremental.tokenOffset (i)) {
+			return false;
+		}
+	}
+
+	// The checkpoints depend on the edits, each is the start of a token less than an interval
+	// before the offset, or of the long token that contains it:
+	std::size_t interval = incremental.checkpointInterval ();
+	for (std::size_t offset = 0; offset < buffer.length (); offset += interval / 3 + 1) {
+		LexerCheckpoint checkpoint = incremental.checkpoint (offset);
+		if (checkpoint.offset > offset || incremental.tokenOffset (checkpoint.tokenIndex) != checkpoint.offset) {
+			return false;
+		}
+		if (offset - checkpoint.offset >= interval && incremental.tokenAt (offset) != checkpoint.tokenIndex) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static TokenSplice splice (IncrementalLexer & lexer, std::size_t offset, std::size_t length, const std::u16string & text) {
+	TextBuffer buffer = lexer.textBuffer ().splice (offset, length, text);
+	return lexer.update (buffer, TextEdit (offset, length, text.length ()));
+}
+
+BOOST_AUTO_TEST_SUITE (TestIncrementalLexer)
+
+BOOST_AUTO_TEST_CASE (testCreate) {
+	IncrementalLexer l (TextBuffer (u"using a.b;"));
+
+	BOOST_CHECK (l.tokenCount () == 6);
+	BOOST_CHECK (l.token (0).type () == TokenType::USING);
+	BOOST_CHECK (l.tokenOffset (5) == 9);
+	BOOST_CHECK (l.tokenAt (3) == 0);
+	BOOST_CHECK (l.tokenAt (6) == 2);
+	BOOST_CHECK (l.tokenAt (10) == 6);
+}
+
+BOOST_AUTO_TEST_CASE (testLocalEdit) {
+	std::u16string text;
+	for (int i = 0; i < 100; ++ i) {
+		text += u"namespace a { using b.c; }\n";
+	}
+
+	IncrementalLexer l ((TextBuffer (text)));
+	TokenSplice s = splice (l, 1360, 1, u"xyz");
+
+	BOOST_CHECK (s.removedTokens <= 4);
+	BOOST_CHECK (s.insertedTokens <= 4);
+	BOOST_CHECK (sameTokens (l, l.textBuffer ()));
+}
+
+BOOST_AUTO_TEST_CASE (testUnterminatedComment) {
+	IncrementalLexer l (TextBuffer (u"a b c d e f g h i j k l m n o p"));
+
+	// Opening a comment swallows the rest of the buffer:
+	TokenSplice s = splice (l, 4, 0, u"/*");
+	BOOST_CHECK (sameTokens (l, l.textBuffer ()));
+	BOOST_CHECK (l.token (l.tokenCount () - 1).type () == TokenType::MULTI_LINE_COMMENT);
+	BOOST_CHECK (l.token (l.tokenCount () - 1).error () == TokenError::UNTERMINATED_COMMENT);
+	BOOST_CHECK (s.firstToken + s.insertedTokens == l.tokenCount ());
+
+	// Closing it restores the tokens after it:
+	splice (l, 12, 0, u"*/");
+	BOOST_CHECK (sameTokens (l, l.textBuffer ()));
+	BOOST_CHECK (l.token (4).type () == TokenType::MULTI_LINE_COMMENT);
+	BOOST_CHECK (l.token (4).error () == TokenError::NO_ERROR);
+
+	// Removing the start of the comment:
+	splice (l, 4, 2, u"");
+	BOOST_CHECK (sameTokens (l, l.textBuffer ()));
+}
+
+BOOST_AUTO_TEST_CASE (testUnterminatedString) {
+	IncrementalLexer l (TextBuffer (u"a = \"b\" + c;\nd = \"e\";\n"));
+
+	splice (l, 4, 1, u"");
+	BOOST_CHECK (sameTokens (l, l.textBuffer ()));
+
+	splice (l, 4, 0, u"\"");
+	BOOST_CHECK (sameTokens (l, l.textBuffer ()));
+
+	splice (l, 0, 0, u"\"");
+	BOOST_CHECK (sameTokens (l, l.textBuffer ()));
+}
+
+BOOST_AUTO_TEST_CASE (testCheckpoints) {
+	std::u16string text;
+	for (int i = 0; i < 200; ++ i) {
+		text += i % 50 == 10 ? u"/* a comment\nover several\nlines */\n" : u"namespace a { using b.c; }\n";
+	}
+
+	IncrementalLexer l (TextBuffer (text), 64);
+	BOOST_CHECK_THROW (IncrementalLexer (TextBuffer (text), 0), std::invalid_argument);
+
+	for (std::size_t offset = 0; offset < text.length (); offset += 7) {
+		LexerCheckpoint checkpoint = l.checkpoint (offset);
+		BOOST_REQUIRE (checkpoint.offset <= offset);
+		BOOST_REQUIRE (l.tokenOffset (checkpoint.tokenIndex) == checkpoint.offset);
+
+		// A viewport lexed from the token at its start has the same tokens as the whole buffer:
+		std::pair<std::size_t, std::size_t> range = l.tokensInRange (offset, offset + 100);
+		Lexer lexer = l.lexerAt (offset);
+		for (std::size_t i = range.first; i < range.second; ++ i) {
+			Token token = lexer.accept ();
+			BOOST_REQUIRE (token.type () == l.token (i).type ());
+			BOOST_REQUIRE (token.length () == l.token (i).length ());
+		}
+		BOOST_REQUIRE (l.tokenOffset (range.first) <= offset);
+		BOOST_REQUIRE (range.second == l.tokenCount () || l.tokenOffset (range.second) >= offset + 100);
+	}
+
+	std::pair<std::size_t, std::size_t> empty = l.tokensInRange (10, 10);
+	BOOST_CHECK (empty.first == empty.second);
+	BOOST_CHECK (l.tokensInRange (text.length (), text.length () + 10).first == l.tokenCount ());
+	BOOST_CHECK (l.lexerAt (text.length ()).check (TokenType::END_OF_INPUT));
+}
+
+BOOST_AUTO_TEST_CASE (testRandomEdits) {
+	static const char16_t * fragments[] = {
+		u" ", u"\n", u"a", u"namespace", u"using", u"/*", u"*/", u"//", u"\"", u"'", u"`",
+		u"\\", u"0x1f", u"1.5e", u"-", u"+=", u"{", u"}", u";", u".", u"#"
+	};
+	static const std::size_t fragmentCount = sizeof (fragments) / sizeof (fragments[0]);
+
+	std::srand (42);
+	IncrementalLexer l (TextBuffer (u"namespace a { using b.c; } // comment\n"), 8);
+
+	for (int i = 0; i < 2000; ++ i) {
+		std::size_t length = l.textBuffer ().length ();
+		std::size_t offset = std::rand () % (length + 1);
+		std::size_t removed = std::rand () % 4;
+		if (offset + removed > length) {
+			removed = length - offset;
+		}
+
+		std::u16string text;
+		for (int n = std::rand () % 3; n > 0; -- n) {
+			text += fragments[std::rand () % fragmentCount];
+		}
+
+		splice (l, offset, removed, text);
+		BOOST_REQUIRE (sameTokens (l, l.textBuffer ()));
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testEditsAcrossBlocks) {
+	std::u16string text;
+	for (int i = 0; i < 400; ++ i) {
+		text += i % 50 == 10 ? u"/* a comment\nover several\nlines */\n" : u"namespace a { using b.c; }\n";
+	}
+
+	std::srand (7);
+	IncrementalLexer l (TextBuffer (text), 256);
+
+	// Edits anywhere, some of them large enough to span blocks:
+	for (int i = 0; i < 300; ++ i) {
+		std::size_t length = l.textBuffer ().length ();
+		std::size_t offset = std::rand () % (length + 1);
+		std::size_t removed = std::min<std::size_t> (i % 10 == 0 ? std::rand () % 3000 : std::rand () % 4, length - offset);
+		std::u16string inserted = i % 7 == 0 ? u"/*" : i % 10 == 5 ? text.substr (0, std::rand () % 3000) : u"x;";
+
+		TokenSplice s = splice (l, offset, removed, inserted);
+		BOOST_REQUIRE (sameTokens (l, l.textBuffer ()));
+		BOOST_REQUIRE (s.firstToken + s.insertedTokens <= l.tokenCount ());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
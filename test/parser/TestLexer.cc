@@ -139,6 +139,18 @@ BOOST_AUTO_TEST_CASE (testKeyword) {
 	BOOST_CHECK (l.la (4).length () == 2);
 }
 
+BOOST_AUTO_TEST_CASE (testKeywordPrefixes) {
+	Lexer l = mkLexer (u"namespaces usin Using using_ namespacenamespace");
+
+	BOOST_CHECK (l.check (TokenType::NAME, 0));
+	BOOST_CHECK (l.la (0).length () == 10);
+	BOOST_CHECK (l.check (TokenType::NAME, 2));
+	BOOST_CHECK (l.check (TokenType::NAME, 4));
+	BOOST_CHECK (l.check (TokenType::NAME, 6));
+	BOOST_CHECK (l.check (TokenType::NAME, 8));
+	BOOST_CHECK (l.la (8).length () == 18);
+}
+
 BOOST_AUTO_TEST_CASE (testName) {
 	{
 		Lexer l = mkLexer (u"  _abcd01  $efgh1  ");
@@ -161,6 +173,25 @@ BOOST_AUTO_TEST_CASE (testName) {
 	}
 }
 
+BOOST_AUTO_TEST_CASE (testNameSymbols) {
+	SymbolTable symbols;
+	std::u16string longName (100, u'x');
+	TextBuffer buffer (u"abc namespace abc d " + longName);
+	Lexer l (buffer, buffer.begin (), buffer.end (), &symbols);
+
+	BOOST_CHECK (l.la (0).symbol () != SymbolTable::noSymbol);
+	BOOST_CHECK (symbols.name (l.la (0).symbol ()) == u"abc");
+	BOOST_CHECK (l.la (2).symbol () == SymbolTable::noSymbol);
+	BOOST_CHECK (l.la (4).symbol () == l.la (0).symbol ());
+	BOOST_CHECK (l.la (6).symbol () != l.la (0).symbol ());
+	BOOST_CHECK (symbols.name (l.la (8).symbol ()) == longName);
+	BOOST_CHECK (symbols.size () == 3);
+
+	// Without a symbol table, names aren't interned:
+	Lexer plain (buffer, buffer.begin (), buffer.end ());
+	BOOST_CHECK (plain.la (0).symbol () == SymbolTable::noSymbol);
+}
+
 BOOST_AUTO_TEST_CASE (testPunctuation) {
 	{
 		Lexer l = mkLexer (u"  ++ - >=/  ");
@@ -188,6 +219,17 @@ BOOST_AUTO_TEST_CASE (testPunctuation) {
 		BOOST_CHECK (l.check (TokenType::LEFT_CURLY, 0));
 		BOOST_CHECK (l.check (TokenType::RIGHT_CURLY, 1));
 	}
+	{
+		Lexer l = mkLexer (u"^^=|||&&&");
+
+		BOOST_CHECK (l.check (TokenType::LOGICAL_XOR, 0));
+		BOOST_CHECK (l.check (TokenType::ASSIGN, 1));
+		BOOST_CHECK (l.check (TokenType::LOGICAL_OR, 2));
+		BOOST_CHECK (l.check (TokenType::BIT_OR, 3));
+		BOOST_CHECK (l.check (TokenType::LOGICAL_AND, 4));
+		BOOST_CHECK (l.check (TokenType::BIT_AND, 5));
+		BOOST_CHECK (l.check (TokenType::END_OF_INPUT, 6));
+	}
 }
 
 BOOST_AUTO_TEST_CASE (testDecimal) {
@@ -217,6 +259,33 @@ BOOST_AUTO_TEST_CASE (testHex) {
 }
 
 
+BOOST_AUTO_TEST_CASE (testLeafBoundaries) {
+	// Build a buffer out of single character leaves, so that every token crosses leaves:
+	std::u16string source (u"  // comment\n/* multi\n * line */ name_123 \"string \\\" value\" 12.5e3 0xff @@@ ");
+	TextBuffer buffer;
+	for (char16_t c: source) {
+		buffer = buffer.append (TextBuffer (std::u16string (1, c)));
+	}
+
+	Lexer l (buffer, buffer.begin (), buffer.end ());
+
+	BOOST_CHECK (l.check (TokenType::WHITESPACE, 0) && l.la (0).length () == 2);
+	BOOST_CHECK (l.check (TokenType::SINGLE_LINE_COMMENT, 1) && l.la (1).length () == 11);
+	BOOST_CHECK (l.check (TokenType::MULTI_LINE_COMMENT, 2) && l.la (2).length () == 19);
+	BOOST_CHECK (l.check (TokenType::WHITESPACE, 3) && l.la (3).length () == 1);
+	BOOST_CHECK (l.check (TokenType::NAME, 4) && l.la (4).length () == 8);
+	BOOST_CHECK (l.check (TokenType::WHITESPACE, 5));
+	BOOST_CHECK (l.check (TokenType::STRING_CONSTANT, 6) && l.la (6).length () == 17);
+	BOOST_CHECK (l.check (TokenType::WHITESPACE, 7));
+	BOOST_CHECK (l.check (TokenType::DECIMAL_CONSTANT, 8) && l.la (8).length () == 6);
+	BOOST_CHECK (l.check (TokenType::WHITESPACE, 9));
+	BOOST_CHECK (l.check (TokenType::HEX_CONSTANT, 10) && l.la (10).length () == 4);
+	BOOST_CHECK (l.check (TokenType::WHITESPACE, 11));
+	BOOST_CHECK (l.check (TokenType::INVALID_CHARACTERS, 12) && l.la (12).length () == 3);
+	BOOST_CHECK (l.check (TokenType::WHITESPACE, 13) && l.la (13).length () == 1);
+	BOOST_CHECK (l.check (TokenType::END_OF_INPUT, 14));
+}
+
 BOOST_AUTO_TEST_CASE (testErrorInvalidCharacters) {
 	Lexer l = mkLexer (u"  @abcde  ");
 
@@ -0,0 +1,178 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/NumericLiteral.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+// Decodes a single literal:
+static NumericLiteral decode (const std::string & text) {
+	TextBuffer buffer (std::u16string (text.begin (), text.end ()));
+	NumericLiteralTable literals;
+	Lexer lexer (buffer, buffer.begin (), buffer.end (), nullptr, &literals);
+
+	BOOST_REQUIRE (lexer.la ().length () == text.length ());
+	BOOST_REQUIRE (literals.find (0) != nullptr);
+	return *literals.find (0);
+}
+
+static bool sameBits (double a, double b) {
+	return std::memcmp (&a, &b, sizeof (double)) == 0;
+}
+
+static bool sameBits (float a, float b) {
+	return std::memcmp (&a, &b, sizeof (float)) == 0;
+}
+
+BOOST_AUTO_TEST_SUITE (TestNumericLiteral)
+
+BOOST_AUTO_TEST_CASE (testTokenIndices) {
+	TextBuffer buffer (u"  123 -42l 0.1 .1f 1.1e+03d 0xd3AdB33f 1.e5 x");
+	NumericLiteralTable literals;
+	Lexer l (buffer, buffer.begin (), buffer.end (), nullptr, &literals);
+
+	while (!l.check (TokenType::END_OF_INPUT)) {
+		l.accept ();
+	}
+
+	// The invalid 1.e5 has no value:
+	BOOST_REQUIRE (literals.size () == 6);
+	BOOST_CHECK (literals.find (0) == nullptr);
+	BOOST_CHECK (literals.find (13) == nullptr);
+
+	BOOST_CHECK (literals.find (1)->type == NumericType::INT && literals.find (1)->integerValue == 123);
+	BOOST_CHECK (literals.find (3)->type == NumericType::LONG && literals.find (3)->integerValue == -42);
+	BOOST_CHECK (literals.find (5)->type == NumericType::DOUBLE && literals.find (5)->floatingValue == 0.1);
+	BOOST_CHECK (literals.find (7)->type == NumericType::FLOAT && literals.find (7)->floatingValue == 0.1f);
+	BOOST_CHECK (literals.find (9)->type == NumericType::DOUBLE && literals.find (9)->floatingValue == 1100);
+	BOOST_CHECK (literals.find (11)->type == NumericType::INT && literals.find (11)->integerValue == 0xd3adb33f);
+}
+
+BOOST_AUTO_TEST_CASE (testIntegerOverflow) {
+	BOOST_CHECK (!decode ("2147483647").overflow);
+	BOOST_CHECK (decode ("2147483648").overflow);
+	BOOST_CHECK (!decode ("-2147483648").overflow);
+	BOOST_CHECK (decode ("-2147483648").integerValue == INT32_MIN);
+	BOOST_CHECK (decode ("-2147483649").overflow);
+
+	BOOST_CHECK (!decode ("9223372036854775807l").overflow);
+	BOOST_CHECK (decode ("9223372036854775807l").integerValue == INT64_MAX);
+	BOOST_CHECK (decode ("9223372036854775808l").overflow);
+	BOOST_CHECK (decode ("-9223372036854775808L").integerValue == INT64_MIN);
+	BOOST_CHECK (!decode ("-9223372036854775808L").overflow);
+	BOOST_CHECK (decode ("123456789012345678901234567890l").overflow);
+
+	// Suffixes turn integers into floating point:
+	BOOST_CHECK (decode ("12f").type == NumericType::FLOAT && decode ("12f").floatingValue == 12);
+	BOOST_CHECK (decode ("99999999999999999999999d").floatingValue == 1e23);
+	BOOST_CHECK (!decode ("99999999999999999999999d").overflow);
+
+	BOOST_CHECK (decode ("0xffffffff").type == NumericType::INT);
+	BOOST_CHECK (decode ("0x100000000").type == NumericType::LONG);
+	BOOST_CHECK (decode ("0xffffffffffffffff").integerValue == -1);
+	BOOST_CHECK (!decode ("0xffffffffffffffff").overflow);
+	BOOST_CHECK (decode ("0x10000000000000000").overflow);
+}
+
+BOOST_AUTO_TEST_CASE (testFloatingPointLimits) {
+	BOOST_CHECK (decode ("1e309").overflow);
+	BOOST_CHECK (std::isinf (decode ("1e309").floatingValue));
+	BOOST_CHECK (decode ("-1e99999999999").floatingValue == -HUGE_VAL);
+	BOOST_CHECK (decode ("1e-400").floatingValue == 0 && !decode ("1e-400").overflow);
+	BOOST_CHECK (decode ("4.9406564584124654e-324").floatingValue == 4.9406564584124654e-324);
+	BOOST_CHECK (decode ("2.2250738585072011e-308").floatingValue == 2.2250738585072011e-308);
+	BOOST_CHECK (decode ("1.7976931348623157e308").floatingValue == 1.7976931348623157e308);
+	BOOST_CHECK (decode ("3.5e38f").overflow);
+	BOOST_CHECK (decode ("3.4028234e38f").floatingValue == 3.4028234e38f);
+	BOOST_CHECK (decode ("1.4e-45f").floatingValue == 1.4e-45f);
+	BOOST_CHECK (decode ("0.0000000000000000000000000000000000000000001d").floatingValue == 1e-43);
+
+	// Halfway cases that need more than 19 digits to round:
+	BOOST_CHECK (sameBits (decode ("9007199254740993.0000000000000000001").floatingValue, 9007199254740994.0));
+	BOOST_CHECK (sameBits (decode ("9007199254740993.0000000000000000000").floatingValue, 9007199254740992.0));
+	BOOST_CHECK (sameBits (decode ("2.47032822920623272088e-324").floatingValue, 0.0));
+	BOOST_CHECK (sameBits (decode ("2.47032822920623272089e-324").floatingValue, 4.9406564584124654e-324));
+}
+
+BOOST_AUTO_TEST_CASE (testRandomDoubles) {
+	std::mt19937_64 random (17);
+	char text[64];
+
+	for (int i = 0; i < 20000; ++ i) {
+		double value;
+		do {
+			std::uint64_t bits = random ();
+			std::memcpy (&value, &bits, sizeof (value));
+		} while (!std::isfinite (value));
+
+		// Both exact and shortened representations:
+		int precision = i % 2 == 0 ? 17 : 1 + int (random () % 17);
+		std::snprintf (text, sizeof (text), "%.*ed", precision, value);
+
+		double expected = std::strtod (text, nullptr);
+		NumericLiteral literal = decode (text);
+		BOOST_CHECK (literal.type == NumericType::DOUBLE);
+		BOOST_CHECK_MESSAGE (sameBits (literal.floatingValue, expected), text);
+		BOOST_CHECK (!literal.overflow);
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testRandomFloats) {
+	std::mt19937 random (19);
+	char text[64];
+
+	for (int i = 0; i < 20000; ++ i) {
+		float value;
+		do {
+			std::uint32_t bits = random ();
+			std::memcpy (&value, &bits, sizeof (value));
+		} while (!std::isfinite (value));
+
+		int precision = i % 2 == 0 ? 9 : 1 + int (random () % 9);
+		std::snprintf (text, sizeof (text), "%.*ef", precision, double (value));
+
+		float expected = std::strtof (text, nullptr);
+		NumericLiteral literal = decode (text);
+		BOOST_CHECK (literal.type == NumericType::FLOAT);
+		BOOST_CHECK_MESSAGE (sameBits (float (literal.floatingValue), expected), text);
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testLongDigitSequences) {
+	std::mt19937 random (23);
+
+	for (int i = 0; i < 20000; ++ i) {
+		std::string text;
+		int digits = 1 + random () % 40;
+		int dot = random () % (digits + 1);
+		for (int d = 0; d < digits; ++ d) {
+			if (d == dot) {
+				text += '.';
+			}
+			// Mostly zeros and nines, which land near halfway points:
+			unsigned r = random () % 4;
+			text += char (r == 0 ? '0' + random () % 10 : r == 1 ? '0' : r == 2 ? '9' : '5');
+		}
+		if (dot == digits) {
+			text += ".0";
+		}
+		text += "e" + std::to_string (int (random () % 700) - 350);
+
+		double expected = std::strtod (text.c_str (), nullptr);
+		BOOST_CHECK_MESSAGE (sameBits (decode (text).floatingValue, expected), text);
+
+		float expectedFloat = std::strtof (text.c_str (), nullptr);
+		BOOST_CHECK_MESSAGE (sameBits (float (decode (text + "f").floatingValue), expectedFloat), text);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
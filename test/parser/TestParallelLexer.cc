@@ -0,0 +1,82 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/ThreadPool.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/ParallelLexer.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+static bool lexesSerially (ParallelLexer & parallel, const TextBuffer & buffer) {
+	std::vector<Token> tokens = parallel.lex (buffer);
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+
+	for (const Token & token: tokens) {
+		Token expected = lexer.accept ();
+		if (expected.type () != token.type () || expected.error () != token.error ()
+				|| expected.length () != token.length () || expected.hasLineBreak () != token.hasLineBreak ()) {
+			return false;
+		}
+	}
+	return lexer.check (TokenType::END_OF_INPUT);
+}
+
+BOOST_AUTO_TEST_SUITE (TestParallelLexer)
+
+BOOST_AUTO_TEST_CASE (testEmpty) {
+	ThreadPool pool (2);
+	ParallelLexer lexer (pool, 4);
+
+	BOOST_CHECK (lexer.lex (TextBuffer ()).empty ());
+}
+
+BOOST_AUTO_TEST_CASE (testSplitLines) {
+	ThreadPool pool (2);
+	ParallelLexer lexer (pool, 16);
+
+	std::u16string text;
+	for (int i = 0; i < 20; ++ i) {
+		text += u"using a.b;\n    namespace c { }\n";
+	}
+	TextBuffer buffer (text);
+
+	BOOST_CHECK (lexesSerially (lexer, buffer));
+	BOOST_CHECK (lexer.chunkCount () > 10);
+	BOOST_CHECK (lexer.repairedChunkCount () == 0);
+}
+
+BOOST_AUTO_TEST_CASE (testSplitInsideComment) {
+	ThreadPool pool (2);
+	ParallelLexer lexer (pool, 16);
+
+	TextBuffer buffer (u"a /* first line\nsecond line\nthird line\nfourth line\n*/ b\n\"an unterminated\nstring\nc\n/* unterminated\nd\ne\nf\n");
+
+	BOOST_CHECK (lexesSerially (lexer, buffer));
+	BOOST_CHECK (lexer.repairedChunkCount () > 0);
+}
+
+BOOST_AUTO_TEST_CASE (testRandom) {
+	static const char16_t * fragments[] = {
+		u" ", u"\n", u"\n  ", u"a", u"namespace", u"/*", u"*/", u"//", u"\"", u"'", u"`",
+		u"\\", u"0x1f", u"1.5e", u"-", u"+=", u"{", u"}", u";", u".", u"#"
+	};
+	static const std::size_t fragmentCount = sizeof (fragments) / sizeof (fragments[0]);
+
+	ThreadPool pool (3);
+	std::srand (7);
+
+	for (int i = 0; i < 200; ++ i) {
+		std::u16string text;
+		for (int n = std::rand () % 200; n > 0; -- n) {
+			text += fragments[std::rand () % fragmentCount];
+		}
+
+		ParallelLexer lexer (pool, 1 + std::rand () % 32);
+		BOOST_REQUIRE (lexesSerially (lexer, TextBuffer (text)));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
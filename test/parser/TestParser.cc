@@ -2,11 +2,17 @@
 #define BOOST_TEST_MODULE	Cyclone Parser
 #include <boost/test/unit_test.hpp>
 
+#include <cstdlib>
+#include <future>
 #include <iostream>
+#include <cyclone/core/CancellationToken.h>
 #include <cyclone/core/TextBuffer.h>
+#include <cyclone/core/ThreadPool.h>
 #include <cyclone/parser/Lexer.h>
 #include <cyclone/parser/Parser.h>
+#include <cyclone/syntaxtree/TreeBuilder.h>
 #include <utf8/utf8.h>
+#include "TreeComparison.h"
 
 
 using namespace cyclone::core;
@@ -66,6 +72,9 @@ static void printTree (const TextBuffer & buffer, const std::shared_ptr<NodeBase
 		case NodeType::SCOPED_NAME:
 			std::cout << "SCOPED_NAME";
 			break;
+		case NodeType::NAMESPACE_BODY:
+			std::cout << "NAMESPACE_BODY";
+			break;
 		}
 		std::cout << std::endl;
 
@@ -76,6 +85,12 @@ static void printTree (const TextBuffer & buffer, const std::shared_ptr<NodeBase
 	}
 }
 
+static SyntaxTree parse (const TextBuffer & buffer) {
+	Lexer l (buffer, buffer.begin (), buffer.end ());
+	Parser p (l);
+	return p.parse ();
+}
+
 BOOST_AUTO_TEST_SUITE(TestParser)
 
 BOOST_AUTO_TEST_CASE (my_test) {
@@ -110,4 +125,415 @@ BOOST_AUTO_TEST_CASE (testParseCompilationUnit) {
 	}
 }
 
+BOOST_AUTO_TEST_CASE (testParseErrorTokens) {
+	// The unexpected tokens before the semicolon end up in ERROR nodes of the USING node:
+	TextBuffer buffer (u"using a b c; namespace d { }");
+	Lexer l (buffer, buffer.begin (), buffer.end ());
+	Parser p (l);
+
+	Parser::Result cu = p.parseCompilationUnit ();
+
+	BOOST_REQUIRE (cu->nodeCount () == 3);
+	BOOST_CHECK (cu->length () == buffer.length ());
+
+	std::shared_ptr<Node> usingNode = std::static_pointer_cast<Node> (cu->node (0));
+	BOOST_CHECK (usingNode->type () == NodeType::USING);
+	BOOST_CHECK (usingNode->length () == 12);
+
+	unsigned errors = 0;
+	for (unsigned i = 0; i < usingNode->nodeCount (); ++ i) {
+		if (usingNode->node (i)->isNode () && std::static_pointer_cast<Node> (usingNode->node (i))->type () == NodeType::ERROR) {
+			++ errors;
+		}
+	}
+	BOOST_CHECK (errors == 2);
+}
+
+// Compares pathAt with a linear scan over the children:
+static bool samePath (const SyntaxTree & tree, std::size_t offset) {
+	SyntaxTree::Path path = tree.pathAt (offset);
+	if (offset >= tree.root ()->length ()) {
+		return path.empty ();
+	}
+
+	std::shared_ptr<NodeBase> node = tree.root ();
+	std::size_t start = 0;
+	for (std::size_t depth = 0; ; ++ depth) {
+		if (depth >= path.size () || path[depth].node != node || path[depth].offset != start) {
+			return false;
+		}
+		if (node->isTerminal ()) {
+			return depth + 1 == path.size ();
+		}
+
+		std::shared_ptr<Node> n = std::static_pointer_cast<Node> (node);
+		unsigned i = 0;
+		while (start + n->node (i)->length () <= offset) {
+			start += n->node (i ++)->length ();
+		}
+		node = n->node (i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testPathAt) {
+	TextBuffer buffer (u"using a b c; /* d */ namespace e.f {\n\tusing g = h;\n\tnamespace { } }\n");
+	SyntaxTree tree = parse (buffer);
+
+	for (std::size_t offset = 0; offset <= buffer.length (); ++ offset) {
+		BOOST_CHECK (samePath (tree, offset));
+	}
+
+	SyntaxTree::Path path = tree.pathAt (buffer.toString ().find (u"g ="));
+	BOOST_REQUIRE (path.size () == 5);
+	BOOST_CHECK (std::static_pointer_cast<Node> (path[1].node)->type () == NodeType::NAMESPACE);
+	BOOST_CHECK (std::static_pointer_cast<Node> (path[2].node)->type () == NodeType::USING);
+	BOOST_CHECK (std::static_pointer_cast<Node> (path[3].node)->type () == NodeType::SCOPED_NAME);
+	BOOST_CHECK (path[4].node->isTerminal ());
+	BOOST_CHECK (path[4].offset == buffer.toString ().find (u"g ="));
+	BOOST_CHECK (path[1].index == 1);
+}
+
+BOOST_AUTO_TEST_CASE (testReparseReusesSubtrees) {
+	std::u16string block (u"namespace a {\n\tusing b.c;\n\tnamespace d {\n\t\tusing e.f = g;\n\t}\n}\n");
+	std::u16string text;
+	for (int i = 0; i < 100; ++ i) {
+		text += block;
+	}
+
+	TextBuffer buffer (text);
+	SyntaxTree tree = parse (buffer);
+
+	// Rename f in the 50th namespace, only its USING node is reparsed:
+	std::size_t offset = 49 * block.length () + block.find (u"f =");
+	TextBuffer edited = buffer.splice (offset, 1, u"xyz");
+	SyntaxTree reparsed = Parser::reparse (tree, edited, TextEdit (offset, 1, 3));
+
+	BOOST_REQUIRE (sameTree (reparsed.root (), parse (edited).root ()));
+	BOOST_CHECK (reparsed.root ()->length () == edited.length ());
+	BOOST_CHECK (reparsed.root ()->node (48) == tree.root ()->node (48));
+	BOOST_CHECK (reparsed.root ()->node (49) != tree.root ()->node (49));
+	BOOST_CHECK (reparsed.root ()->node (50) == tree.root ()->node (50));
+
+	std::shared_ptr<Node> oldNamespace = std::static_pointer_cast<Node> (tree.root ()->node (49));
+	std::shared_ptr<Node> newNamespace = std::static_pointer_cast<Node> (reparsed.root ()->node (49));
+	for (unsigned i = 0; i < newNamespace->nodeCount (); ++ i) {
+		if (newNamespace->node (i)->isTerminal () || std::static_pointer_cast<Node> (newNamespace->node (i))->type () == NodeType::USING) {
+			BOOST_CHECK (newNamespace->node (i) == oldNamespace->node (i));
+		}
+	}
+
+	// The old tree is unchanged:
+	BOOST_CHECK (sameTree (tree.root (), parse (buffer).root ()));
+
+	// Removing a closing brace makes the namespace swallow the next one, the whole unit is reparsed:
+	offset = 49 * block.length () + block.find (u"}\n}") + 2;
+	edited = buffer.splice (offset, 1, u"");
+	reparsed = Parser::reparse (tree, edited, TextEdit (offset, 1, 0));
+	BOOST_CHECK (sameTree (reparsed.root (), parse (edited).root ()));
+	BOOST_CHECK (reparsed.root ()->node (48) != tree.root ()->node (48));
+}
+
+BOOST_AUTO_TEST_CASE (testReparseRandomEdits) {
+	static const char16_t * fragments[] = {
+		u" ", u"\n", u"a", u"b.c", u"namespace", u"using", u"/*", u"*/", u"// c\n", u"\"", u"{", u"}", u";", u".", u"=", u"#"
+	};
+	static const std::size_t fragmentCount = sizeof (fragments) / sizeof (fragments[0]);
+
+	std::u16string initial;
+	for (int i = 0; i < 8; ++ i) {
+		initial += u"namespace alpha {\n\tusing beta.gamma;\n\tnamespace delta { using epsilon; }\n}\nusing zeta = eta;\n";
+	}
+
+	std::srand (7);
+	TextBuffer buffer (initial);
+	SyntaxTree tree = parse (buffer);
+
+	for (int i = 0; i < 3000; ++ i) {
+		std::size_t length = buffer.length ();
+		std::size_t offset = std::rand () % (length + 1);
+		std::size_t removed = std::min<std::size_t> (std::rand () % 4, length - offset);
+
+		std::u16string text;
+		for (int n = std::rand () % 3; n > 0; -- n) {
+			text += fragments[std::rand () % fragmentCount];
+		}
+
+		buffer = buffer.splice (offset, removed, text);
+		tree = Parser::reparse (tree, buffer, TextEdit (offset, removed, text.length ()));
+		BOOST_REQUIRE (sameTree (tree.root (), parse (buffer).root ()));
+		BOOST_REQUIRE (samePath (tree, offset));
+
+		// Start over from time to time, the edits tend to break the text:
+		if (i % 20 == 19) {
+			buffer = TextBuffer (initial);
+			tree = parse (buffer);
+		}
+	}
+}
+
+// The tree parse () makes: the children of each NAMESPACE_BODY in place of its lazy node:
+static std::shared_ptr<NodeBase> expandLazy (const std::shared_ptr<NodeBase> & node) {
+	if (node->isTerminal ()) {
+		return node;
+	}
+
+	std::shared_ptr<Node> n = std::static_pointer_cast<Node> (node);
+	std::shared_ptr<Node> expanded = std::make_shared<Node> (n->type ());
+	for (unsigned i = 0; i < n->nodeCount (); ++ i) {
+		std::shared_ptr<NodeBase> child = n->node (i);
+		if (!child->isLazy ()) {
+			expanded->addNode (expandLazy (child));
+			continue;
+		}
+
+		std::shared_ptr<Node> body = std::static_pointer_cast<LazyNode> (child)->node ();
+		BOOST_CHECK (body->type () == NodeType::NAMESPACE_BODY);
+		BOOST_CHECK (body->length () == child->length ());
+		for (unsigned j = 0; j < body->nodeCount (); ++ j) {
+			expanded->addNode (expandLazy (body->node (j)));
+		}
+	}
+	return expanded;
+}
+
+BOOST_AUTO_TEST_CASE (testParseLazily) {
+	const char16_t * sources[] = {
+		u"",
+		u"using a.b; /* c */ namespace d { namespace e { using f = g; } }\n",
+		u"namespace a {\n\t// b\n\tusing c.d;\n\tnamespace e {}\n\t/* f */\n}\nnamespace g { }",
+		u"using x;\nnamespace a { namespace b { namespace c {using d;/* e */} // f\n}}\nnamespace g {using h;}"
+	};
+
+	for (const char16_t * source: sources) {
+		TextBuffer buffer (source);
+		SyntaxTree lazy = Parser::parseLazily (buffer);
+		BOOST_CHECK (lazy.root ()->length () == buffer.length ());
+		BOOST_CHECK (sameTree (expandLazy (lazy.root ()), parse (buffer).root ()));
+	}
+
+	// Only the top level is parsed, the body is between the braces:
+	TextBuffer buffer (u"using a;\nnamespace b.c {\n\tusing d;\n\tnamespace e { using f; }\n}\n");
+	SyntaxTree lazy = Parser::parseLazily (buffer);
+	std::shared_ptr<Node> ns = std::static_pointer_cast<Node> (lazy.root ()->node (1));
+	BOOST_REQUIRE (ns->type () == NodeType::NAMESPACE);
+
+	unsigned i = 0;
+	while (i < ns->nodeCount () && !ns->node (i)->isLazy ()) {
+		++ i;
+	}
+	BOOST_REQUIRE (i + 2 == ns->nodeCount ());
+	std::size_t body = ns->offset (i) + lazy.root ()->offset (1);
+	BOOST_CHECK (buffer.toString ().substr (body - 1, ns->node (i)->length () + 2) == u"{\n\tusing d;\n\tnamespace e { using f; }\n}");
+
+	// The nested namespace is lazy again:
+	SyntaxTree::Path path = lazy.pathAt (buffer.toString ().find (u"using f"));
+	BOOST_REQUIRE (path.size () >= 5);
+	BOOST_CHECK (std::static_pointer_cast<Node> (path[2].node)->type () == NodeType::NAMESPACE_BODY);
+	BOOST_CHECK (std::static_pointer_cast<Node> (path[4].node)->type () == NodeType::NAMESPACE_BODY);
+	BOOST_CHECK (path.back ().node->isTerminal ());
+
+	// Reparsing keeps the tree lazy:
+	BOOST_CHECK (lazy.isLazy ());
+	BOOST_CHECK (!parse (buffer).isLazy ());
+	std::size_t edit = buffer.toString ().find (u"using d");
+	TextBuffer edited = buffer.splice (edit + 6, 1, u"x.y");
+	SyntaxTree reparsed = Parser::reparse (lazy, edited, TextEdit (edit + 6, 1, 3));
+	BOOST_CHECK (reparsed.isLazy ());
+	BOOST_CHECK (std::static_pointer_cast<Node> (reparsed.root ()->node (1))->node (i)->isLazy ());
+	BOOST_CHECK (sameTree (expandLazy (reparsed.root ()), parse (edited).root ()));
+
+	// Errors stay in the body:
+	TextBuffer errors (u"namespace a { using b c; { ; } } using d;");
+	SyntaxTree tree = Parser::parseLazily (errors);
+	BOOST_CHECK (expandLazy (tree.root ())->length () == errors.length ());
+	BOOST_CHECK (std::static_pointer_cast<Node> (tree.root ()->node (1))->type () == NodeType::USING);
+}
+
+BOOST_AUTO_TEST_CASE (testParseLazilyThreads) {
+	std::u16string text;
+	for (int i = 0; i < 200; ++ i) {
+		text += u"namespace a {\n\tusing b.c;\n\tnamespace d { using e = f; }\n}\n";
+	}
+	TextBuffer buffer (text);
+	SyntaxTree tree = Parser::parseLazily (buffer);
+	std::shared_ptr<Node> ns = std::static_pointer_cast<Node> (tree.root ()->node (0));
+	std::shared_ptr<LazyNode> body = std::static_pointer_cast<LazyNode> (ns->node (ns->nodeCount () - 2));
+
+	// All threads get the same node:
+	ThreadPool pool (4);
+	std::vector<std::future<std::shared_ptr<Node>>> results;
+	for (int i = 0; i < 16; ++ i) {
+		results.push_back (pool.submit ([body] () { return body->node (); }));
+	}
+	std::shared_ptr<Node> first = results[0].get ();
+	for (std::size_t i = 1; i < results.size (); ++ i) {
+		BOOST_CHECK (results[i].get () == first);
+	}
+
+	BOOST_CHECK (sameTree (expandLazy (tree.root ()), parse (buffer).root ()));
+}
+
+// Checks the events against the tree of the same text, keeping only what is open:
+class CheckingBuilder : public TreeBuilder {
+public:
+
+	CheckingBuilder () : m_offset (0), m_maxDepth (0), m_tokens (0) {
+	}
+
+	virtual void startNode (NodeType type) {
+		m_open.push_back (type);
+		m_maxDepth = std::max (m_maxDepth, m_open.size ());
+	}
+
+	virtual void token (const Token & token, std::size_t offset) {
+		BOOST_CHECK (!m_open.empty ());
+		BOOST_CHECK (offset == m_offset);
+		m_offset += token.length ();
+		++ m_tokens;
+	}
+
+	virtual void finishNode () {
+		m_open.pop_back ();
+	}
+
+	virtual void error (TokenType expected, std::size_t offset) {
+		errors.push_back (std::make_pair (expected, offset));
+	}
+
+	std::vector<std::pair<TokenType, std::size_t>>	errors;
+
+	std::size_t length () const {
+		return m_offset;
+	}
+
+	std::size_t maxDepth () const {
+		return m_maxDepth;
+	}
+
+	std::size_t tokens () const {
+		return m_tokens;
+	}
+
+	bool done () const {
+		return m_open.empty ();
+	}
+
+private:
+
+	std::vector<NodeType>	m_open;
+	std::size_t				m_offset;
+	std::size_t				m_maxDepth;
+	std::size_t				m_tokens;
+};
+
+static std::size_t countTokens (const std::shared_ptr<NodeBase> & node) {
+	if (node->isTerminal ()) {
+		return 1;
+	}
+
+	std::shared_ptr<Node> n = std::static_pointer_cast<Node> (node);
+	std::size_t count = 0;
+	for (unsigned i = 0; i < n->nodeCount (); ++ i) {
+		count += countTokens (n->node (i));
+	}
+	return count;
+}
+
+BOOST_AUTO_TEST_CASE (testStreamEvents) {
+	std::u16string text;
+	for (int i = 0; i < 100; ++ i) {
+		text += u"namespace a {\n\tusing b.c; // d\n\tnamespace e { using f = g; }\n}\n";
+	}
+	TextBuffer buffer (text);
+
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	CheckingBuilder builder;
+	Parser parser (lexer, builder);
+	BOOST_CHECK (parser.parseCompilationUnit () == nullptr);
+
+	BOOST_CHECK (builder.done ());
+	BOOST_CHECK (builder.errors.empty ());
+	BOOST_CHECK (builder.length () == buffer.length ());
+	BOOST_CHECK (builder.maxDepth () == 5);
+	BOOST_CHECK (builder.tokens () == countTokens (parse (buffer).root ()));
+
+	// The errors point at the token that was found instead:
+	TextBuffer errors (u"using a b;\nnamespace c using d; }");
+	Lexer errorLexer (errors, errors.begin (), errors.end ());
+	CheckingBuilder errorBuilder;
+	Parser errorParser (errorLexer, errorBuilder);
+	errorParser.parseCompilationUnit ();
+
+	BOOST_CHECK (errorBuilder.done ());
+	BOOST_CHECK (errorBuilder.length () <= errors.length ());
+	BOOST_REQUIRE (errorBuilder.errors.size () >= 2);
+	BOOST_CHECK (errorBuilder.errors[0].first == TokenType::SEMICOLON);
+	BOOST_CHECK (errorBuilder.errors[0].second == errors.toString ().find (u"b;"));
+	BOOST_CHECK (errorBuilder.errors[1].first == TokenType::LEFT_CURLY);
+	BOOST_CHECK (errorBuilder.errors[1].second == errors.toString ().find (u"using d"));
+}
+
+BOOST_AUTO_TEST_CASE (testCancellation) {
+	std::u16string text;
+	for (int i = 0; i < 100; ++ i) {
+		text += u"namespace a {\n\tusing b.c; // d\n\tnamespace e { using f = g; }\n}\n";
+	}
+	TextBuffer buffer (text);
+
+	// Not cancelled, the tree is complete:
+	CancellationToken token;
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	Parser parser (lexer);
+	parser.setCancellationToken (token);
+	SyntaxTree tree = parser.parse ();
+	BOOST_CHECK (tree.isComplete ());
+	BOOST_CHECK (sameTree (tree.root (), parse (buffer).root ()));
+
+	// Cancelled, the tree covers a prefix:
+	token.cancel ();
+	Lexer cancelledLexer (buffer, buffer.begin (), buffer.end ());
+	Parser cancelledParser (cancelledLexer);
+	cancelledParser.setCancellationToken (token);
+	SyntaxTree cancelled = cancelledParser.parse ();
+	BOOST_CHECK (!cancelled.isComplete ());
+	BOOST_REQUIRE (cancelled.root () != nullptr);
+	BOOST_CHECK (cancelled.root ()->type () == NodeType::COMPILATION_UNIT);
+	BOOST_CHECK (cancelled.root ()->length () < buffer.length ());
+
+	// Reparsing an incomplete tree parses all of it:
+	TextBuffer edited = buffer.splice (0, 0, u" ");
+	SyntaxTree reparsed = Parser::reparse (cancelled, edited, TextEdit (0, 0, 1));
+	BOOST_CHECK (reparsed.isComplete ());
+	BOOST_CHECK (sameTree (reparsed.root (), parse (edited).root ()));
+
+	// A deadline that has passed:
+	CancellationToken deadline (CancellationToken::Clock::duration::zero ());
+	BOOST_CHECK (deadline.isCancelled ());
+	Lexer deadlineLexer (buffer, buffer.begin (), buffer.end ());
+	Parser deadlineParser (deadlineLexer);
+	deadlineParser.setCancellationToken (deadline);
+	BOOST_CHECK (!deadlineParser.parse ().isComplete ());
+	BOOST_CHECK (!CancellationToken (std::chrono::hours (1)).isCancelled ());
+
+	// The rules that were open are finished before the exception leaves the parser:
+	Lexer builderLexer (buffer, buffer.begin (), buffer.end ());
+	CheckingBuilder builder;
+	Parser builderParser (builderLexer, builder);
+	builderParser.setCancellationToken (token);
+	BOOST_CHECK_THROW (builderParser.parseCompilationUnit (), ParseCancelled);
+	BOOST_CHECK (builder.done ());
+	BOOST_CHECK (builder.length () < buffer.length ());
+
+	// With a builder of its own, parse () returns a tree without a root:
+	Lexer rootLexer (buffer, buffer.begin (), buffer.end ());
+	CheckingBuilder rootBuilder;
+	Parser rootParser (rootLexer, rootBuilder);
+	rootParser.setCancellationToken (token);
+	SyntaxTree noRoot = rootParser.parse ();
+	BOOST_CHECK (!noRoot.isComplete ());
+	BOOST_CHECK (!noRoot.root ());
+	BOOST_CHECK (noRoot.pathAt (0).empty ());
+	BOOST_CHECK (sameTree (Parser::reparse (noRoot, edited, TextEdit (0, 0, 1)).root (), parse (edited).root ()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
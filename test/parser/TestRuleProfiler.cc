@@ -0,0 +1,87 @@
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/Parser.h>
+#include <cyclone/parser/RuleProfiler.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+BOOST_AUTO_TEST_SUITE (TestRuleProfiler)
+
+BOOST_AUTO_TEST_CASE (testStatistics) {
+	RuleProfiler profiler (true);
+
+	// A namespace with a name and an error:
+	profiler.enter (NodeType::NAMESPACE);
+	profiler.token ();
+	profiler.enter (NodeType::SCOPED_NAME);
+	profiler.token ();
+	profiler.leave ();
+	profiler.recovery ();
+	profiler.token ();
+	profiler.leave ();
+
+	const RuleProfiler::Statistics & ns = profiler.statistics (NodeType::NAMESPACE);
+	const RuleProfiler::Statistics & name = profiler.statistics (NodeType::SCOPED_NAME);
+	BOOST_CHECK (ns.calls == 1);
+	BOOST_CHECK (ns.tokens == 2);
+	BOOST_CHECK (ns.nodes == 5);
+	BOOST_CHECK (ns.recoveries == 1);
+	BOOST_CHECK (ns.inclusiveTime >= name.inclusiveTime);
+	BOOST_CHECK (ns.exclusiveTime == ns.inclusiveTime - name.inclusiveTime);
+	BOOST_CHECK (name.calls == 1);
+	BOOST_CHECK (name.tokens == 1);
+	BOOST_CHECK (name.nodes == 2);
+	BOOST_CHECK (name.recoveries == 0);
+	BOOST_CHECK (profiler.statistics (NodeType::USING).calls == 0);
+
+	std::ostringstream report;
+	profiler.writeReport (report);
+	BOOST_CHECK (report.str ().find ("rule\tcalls") == 0);
+	BOOST_CHECK (report.str ().find ("NAMESPACE\t1\t") != std::string::npos);
+	BOOST_CHECK (report.str ().find ("USING") == std::string::npos);
+
+	std::ostringstream trace;
+	profiler.writeChromeTrace (trace);
+	BOOST_CHECK (trace.str ().find ("{\"traceEvents\":[") == 0);
+	BOOST_CHECK (trace.str ().find ("\"name\":\"SCOPED_NAME\"") < trace.str ().find ("\"name\":\"NAMESPACE\""));
+
+	profiler.clear ();
+	BOOST_CHECK (profiler.statistics (NodeType::NAMESPACE).calls == 0);
+}
+
+BOOST_AUTO_TEST_CASE (testParser) {
+	TextBuffer buffer (u"using a.b;\nnamespace c {\n\tusing d = e;\n\tnamespace f { }\n}\nusing g h;\n");
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	Parser parser (lexer);
+	RuleProfiler profiler;
+	parser.setProfiler (profiler);
+	parser.parse ();
+
+	if (!RuleProfiler::enabled) {
+		BOOST_CHECK (profiler.statistics (NodeType::COMPILATION_UNIT).calls == 0);
+		return;
+	}
+
+	const RuleProfiler::Statistics & unit = profiler.statistics (NodeType::COMPILATION_UNIT);
+	BOOST_CHECK (unit.calls == 1);
+	BOOST_CHECK (profiler.statistics (NodeType::NAMESPACE).calls == 2);
+	BOOST_CHECK (profiler.statistics (NodeType::USING).calls == 3);
+	BOOST_CHECK (profiler.statistics (NodeType::SCOPED_NAME).calls == 5);
+	BOOST_CHECK (profiler.statistics (NodeType::USING).recoveries == 1);
+	BOOST_CHECK (profiler.statistics (NodeType::ERROR).calls >= 1);
+
+	// The root counts the whole tree:
+	std::size_t tokens = 0;
+	for (unsigned i = 0; i <= unsigned (NodeType::NAMESPACE_BODY); ++ i) {
+		tokens += profiler.statistics (NodeType (i)).tokens;
+	}
+	BOOST_CHECK (unit.nodes > tokens);
+	BOOST_CHECK (unit.exclusiveTime <= unit.inclusiveTime);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
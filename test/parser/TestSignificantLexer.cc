@@ -0,0 +1,82 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/SignificantLexer.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+BOOST_AUTO_TEST_SUITE (TestSignificantLexer)
+
+BOOST_AUTO_TEST_CASE (testTrivia) {
+	TextBuffer buffer (u"using /* a */ a // b\n  /* c */\n\tb;");
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	SignificantLexer l (lexer);
+
+	BOOST_CHECK (l.check (TokenType::USING, 0));
+	BOOST_CHECK (l.check (TokenType::NAME, 1));
+	BOOST_CHECK (l.check (TokenType::NAME, 2));
+	BOOST_CHECK (l.check (TokenType::SEMICOLON, 3));
+	BOOST_CHECK (l.check (TokenType::END_OF_INPUT, 4));
+
+	SignificantToken usingToken = l.accept ();
+	BOOST_CHECK (usingToken.leadingTrivia.count () == 0);
+	BOOST_CHECK (usingToken.trailingTrivia.count () == 3);
+	BOOST_CHECK (usingToken.trailingTrivia.length == 9);
+	BOOST_CHECK (!usingToken.hasLineBreakBefore);
+
+	// The trailing trivia ends with the single line comment:
+	SignificantToken a = l.accept ();
+	BOOST_CHECK (a.leadingTrivia.count () == 0);
+	BOOST_CHECK (a.trailingTrivia.count () == 2);
+	BOOST_CHECK (l.trivia (a.trailingTrivia.begin + 1).type () == TokenType::SINGLE_LINE_COMMENT);
+
+	SignificantToken b = l.accept ();
+	BOOST_CHECK (b.leadingTrivia.count () == 3);
+	BOOST_CHECK (b.leadingTrivia.length == 11);
+	BOOST_CHECK (b.hasLineBreakBefore);
+	BOOST_CHECK (b.trailingTrivia.count () == 0);
+
+	SignificantToken semicolon = l.accept ();
+	BOOST_CHECK (!semicolon.hasLineBreakBefore);
+	BOOST_CHECK (l.accept ().token.type () == TokenType::END_OF_INPUT);
+}
+
+BOOST_AUTO_TEST_CASE (testLineBreak) {
+	TextBuffer buffer (u"a\nb /* \n */ c");
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	SignificantLexer l (lexer);
+
+	BOOST_CHECK (!l.la (0).hasLineBreakBefore);
+	BOOST_CHECK (l.la (1).hasLineBreakBefore);
+	BOOST_CHECK (l.la (0).trailingTrivia.count () == 1);
+	BOOST_CHECK (l.la (1).leadingTrivia.count () == 0);
+
+	// Only whitespace tokens report line breaks:
+	BOOST_CHECK (!l.la (2).hasLineBreakBefore);
+}
+
+BOOST_AUTO_TEST_CASE (testLongTrivia) {
+	std::u16string text = u"a";
+	for (int i = 0; i < 1000; ++ i) {
+		text += u" /* comment */";
+	}
+	text += u" b";
+
+	TextBuffer buffer (text);
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	SignificantLexer l (lexer);
+
+	BOOST_CHECK (l.check (TokenType::NAME, 1));
+	BOOST_CHECK (l.la (0).trailingTrivia.count () == 2001);
+
+	SignificantToken a = l.accept ();
+	std::size_t length = 0;
+	for (std::size_t i = a.trailingTrivia.begin; i < a.trailingTrivia.end; ++ i) {
+		length += l.trivia (i).length ();
+	}
+	BOOST_CHECK (length == text.length () - 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,97 @@
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <vector>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/Lexer.h>
+#include <cyclone/parser/TokenStream.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+static bool sameToken (const Token & a, const Token & b) {
+	return a.type () == b.type () && a.error () == b.error () && a.length () == b.length ()
+		&& a.hasLineBreak () == b.hasLineBreak () && a.symbol () == b.symbol ();
+}
+
+BOOST_AUTO_TEST_SUITE (TestTokenStream)
+
+BOOST_AUTO_TEST_CASE (testEmpty) {
+	TokenStream s;
+
+	BOOST_CHECK (s.empty ());
+	BOOST_CHECK (s.begin () == s.end ());
+	BOOST_CHECK (s.indexAt (0) == 0);
+	BOOST_CHECK (s.offset (0) == 0);
+}
+
+BOOST_AUTO_TEST_CASE (testRandomAccess) {
+	std::srand (3);
+	std::vector<Token> tokens;
+	TokenStream s;
+
+	for (int i = 0; i < 1000; ++ i) {
+		std::size_t length = 1 + (i % 97 == 0 ? std::rand () % 1000000 : std::rand () % 200);
+		TokenError error = i % 13 == 0 ? TokenError::UNTERMINATED_COMMENT : TokenError::NO_ERROR;
+		std::uint32_t symbol = std::rand () % 4 == 0 ? 1 + std::rand () % 100 : 0;
+		Token token (TokenType (std::rand () % 10), error, length, std::rand () % 3 == 0, symbol);
+		tokens.push_back (token);
+		s.push_back (token);
+	}
+
+	BOOST_REQUIRE (s.size () == tokens.size ());
+
+	std::size_t offset = 0;
+	for (std::size_t i = 0; i < tokens.size (); ++ i) {
+		BOOST_CHECK (sameToken (s[i], tokens[i]));
+		BOOST_CHECK (s.length (i) == tokens[i].length ());
+		BOOST_CHECK (s.offset (i) == offset);
+		BOOST_CHECK (s.indexAt (offset) == i);
+		BOOST_CHECK (s.indexAt (offset + tokens[i].length () - 1) == i);
+		offset += tokens[i].length ();
+	}
+
+	BOOST_CHECK (s.textLength () == offset);
+	BOOST_CHECK (s.indexAt (offset) == s.size ());
+
+	std::size_t index = 0;
+	for (TokenStream::Iterator it = s.begin (); it != s.end (); ++ it, ++ index) {
+		BOOST_CHECK (sameToken (*it, tokens[index]));
+		BOOST_CHECK (it.offset () == s.offset (index));
+	}
+	BOOST_CHECK (index == tokens.size ());
+}
+
+BOOST_AUTO_TEST_CASE (testHugeToken) {
+	TokenStream s;
+	std::size_t huge = std::size_t (1) << 40;
+
+	s.push_back (Token (TokenType::MULTI_LINE_COMMENT, huge));
+	s.push_back (Token (TokenType::NAME, 1));
+
+	BOOST_CHECK (s.length (0) == huge);
+	BOOST_CHECK (s.offset (1) == huge);
+	BOOST_CHECK (s.indexAt (huge) == 1);
+}
+
+BOOST_AUTO_TEST_CASE (testMemoryUsage) {
+	std::u16string text;
+	for (int i = 0; i < 1000; ++ i) {
+		text += u"namespace a.b { using c.d; x = y + 12; } // comment\n";
+	}
+
+	TextBuffer buffer (text);
+	Lexer lexer (buffer, buffer.begin (), buffer.end ());
+	TokenStream s;
+	while (!lexer.check (TokenType::END_OF_INPUT)) {
+		s.push_back (lexer.accept ());
+	}
+	s.shrink_to_fit ();
+
+	BOOST_CHECK (s.textLength () == text.length ());
+	BOOST_CHECK (s.memoryUsage () < s.size () * 3);
+	BOOST_CHECK (s.memoryUsage () * 5 < s.size () * sizeof (Token));
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
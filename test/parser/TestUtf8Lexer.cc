@@ -0,0 +1,109 @@
+#include <boost/test/unit_test.hpp>
+
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include <utf8/utf8.h>
+#include <cyclone/core/SymbolTable.h>
+#include <cyclone/core/TextBuffer.h>
+#include <cyclone/parser/Lexer.h>
+
+using namespace cyclone::core;
+using namespace cyclone::parser;
+using namespace cyclone::syntaxtree;
+
+template<typename L>
+static std::vector<Token> lexAll (L & lexer) {
+	std::vector<Token> tokens;
+	while (!lexer.check (TokenType::END_OF_INPUT)) {
+		tokens.push_back (lexer.accept ());
+	}
+	return tokens;
+}
+
+static std::string randomSource (std::mt19937 & random, std::size_t count) {
+	static const char * const pieces[] = {
+		"namespace", "using", "name_1", "$x", " ", "\n", "\t", "\r\n", "{", "}", "(", ")", ";", ".",
+		"+=", "==", "^^", "12", "0.5e3", "-4l", "0x1F", "\"", "'", "\\", "//", "/*", "*/", "`",
+		"\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\"caf\xc3\xa9\"", "'\xc3\xa9'", "'\xf0\x9f\x98\x80'",
+		"// \xe2\x82\xac\n", "/* \xf0\x9f\x98\x80 */"
+	};
+
+	std::string source;
+	for (std::size_t i = 0; i < count; ++ i) {
+		source += pieces[random () % (sizeof (pieces) / sizeof (pieces[0]))];
+	}
+	return source;
+}
+
+static std::size_t codePoints (const std::u16string & text) {
+	std::size_t count = 0;
+	for (char16_t c: text) {
+		count += c < 0xdc00 || c > 0xdfff;
+	}
+	return count;
+}
+
+BOOST_AUTO_TEST_SUITE (TestUtf8Lexer)
+
+BOOST_AUTO_TEST_CASE (testSameTokens) {
+	std::mt19937 random (5);
+
+	for (int round = 0; round < 200; ++ round) {
+		std::string source = randomSource (random, 1 + random () % 100);
+		std::u16string text;
+		utf8::utf8to16 (source.begin (), source.end (), std::back_inserter (text));
+
+		SymbolTable symbols;
+		TextBuffer buffer (text);
+		Lexer lexer (buffer, buffer.begin (), buffer.end (), &symbols);
+		std::vector<Token> expected = lexAll (lexer);
+
+		Utf8Lexer utf16Lexer (source.data (), source.data () + source.size (), Utf8Lexer::LengthUnit::UTF16, &symbols);
+		Utf8Lexer utf8Lexer (source.data (), source.data () + source.size (), Utf8Lexer::LengthUnit::UTF8);
+		Utf8Lexer codePointLexer (source.data (), source.data () + source.size (), Utf8Lexer::LengthUnit::CODE_POINTS);
+		std::vector<Token> utf16Tokens = lexAll (utf16Lexer);
+		std::vector<Token> utf8Tokens = lexAll (utf8Lexer);
+		std::vector<Token> codePointTokens = lexAll (codePointLexer);
+
+		BOOST_REQUIRE (utf16Tokens.size () == expected.size ());
+		BOOST_REQUIRE (utf8Tokens.size () == expected.size ());
+		BOOST_REQUIRE (codePointTokens.size () == expected.size ());
+
+		std::size_t offset = 0;
+		for (std::size_t i = 0; i < expected.size (); ++ i) {
+			std::u16string tokenText = text.substr (offset, expected[i].length ());
+			std::string tokenBytes;
+			utf8::utf16to8 (tokenText.begin (), tokenText.end (), std::back_inserter (tokenBytes));
+			offset += expected[i].length ();
+
+			BOOST_CHECK (utf16Tokens[i].type () == expected[i].type ());
+			BOOST_CHECK (utf16Tokens[i].error () == expected[i].error ());
+			BOOST_CHECK (utf16Tokens[i].hasLineBreak () == expected[i].hasLineBreak ());
+			BOOST_CHECK (utf16Tokens[i].symbol () == expected[i].symbol ());
+			BOOST_CHECK (utf16Tokens[i].length () == expected[i].length ());
+
+			BOOST_CHECK (utf8Tokens[i].type () == expected[i].type ());
+			BOOST_CHECK (utf8Tokens[i].length () == tokenBytes.size ());
+			BOOST_CHECK (codePointTokens[i].length () == codePoints (tokenText));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE (testInvalidUtf8) {
+	// A stray continuation byte, a truncated sequence, an overlong encoding and an encoded surrogate:
+	std::string source ("a \x80 \xe2\x82 \xc0\xaf \xed\xa0\x80 \"\xff\"");
+	Utf8Lexer l (source.data (), source.data () + source.size (), Utf8Lexer::LengthUnit::UTF8);
+
+	BOOST_CHECK (l.check (TokenType::NAME, 0) && l.la (0).length () == 1);
+	BOOST_CHECK (l.check (TokenType::INVALID_CHARACTERS, 2) && l.la (2).length () == 1);
+	BOOST_CHECK (l.check (TokenType::INVALID_CHARACTERS, 4) && l.la (4).length () == 2);
+	BOOST_CHECK (l.check (TokenType::INVALID_CHARACTERS, 6) && l.la (6).length () == 2);
+	BOOST_CHECK (l.check (TokenType::INVALID_CHARACTERS, 8) && l.la (8).length () == 3);
+	BOOST_CHECK (l.check (TokenType::STRING_CONSTANT, 10) && l.la (10).length () == 3);
+	BOOST_CHECK (l.la (10).error () == TokenError::NO_ERROR);
+	BOOST_CHECK (l.check (TokenType::END_OF_INPUT, 11));
+}
+
+BOOST_AUTO_TEST_SUITE_END ()
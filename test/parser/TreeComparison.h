@@ -0,0 +1,36 @@
+#ifndef CYCLONE_TEST_PARSER_TREECOMPARISON_H__
+#define CYCLONE_TEST_PARSER_TREECOMPARISON_H__
+
+#include <memory>
+#include <cyclone/syntaxtree/Node.h>
+#include <cyclone/syntaxtree/Token.h>
+
+// Whether the trees have the same structure, lengths and tokens, for the tests:
+inline bool sameTree (const std::shared_ptr<cyclone::syntaxtree::NodeBase> & a, const std::shared_ptr<cyclone::syntaxtree::NodeBase> & b) {
+	using namespace cyclone::syntaxtree;
+
+	if (a->isTerminal () != b->isTerminal () || a->length () != b->length ()) {
+		return false;
+	}
+
+	if (a->isTerminal ()) {
+		Token ta = std::static_pointer_cast<Terminal> (a)->token ();
+		Token tb = std::static_pointer_cast<Terminal> (b)->token ();
+		return ta.type () == tb.type () && ta.error () == tb.error () && ta.hasLineBreak () == tb.hasLineBreak ();
+	}
+
+	std::shared_ptr<Node> na = std::static_pointer_cast<Node> (a);
+	std::shared_ptr<Node> nb = std::static_pointer_cast<Node> (b);
+	if (na->type () != nb->type () || na->nodeCount () != nb->nodeCount ()) {
+		return false;
+	}
+
+	for (unsigned i = 0; i < na->nodeCount (); ++ i) {
+		if (!sameTree (na->node (i), nb->node (i))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#endif	// CYCLONE_TEST_PARSER_TREECOMPARISON_H__